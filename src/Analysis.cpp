@@ -0,0 +1,370 @@
+#include "Analysis.hpp"
+#include "NodeTable.hpp"
+#include <vector>
+#include <algorithm>
+#include <ranges>
+#include <cmath>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+
+using namespace bddHelper;
+
+namespace
+{
+  // 2^x as double. Counts of combinations don't fit into integers.
+  double pow2(int x)
+  {
+    return std::ldexp(1.0, x);
+  }
+
+  // Nodes of formula in level order, see NodeTable.hpp
+  using NodeGraph = nodeTable::NodeTable;
+
+  // Variables of one object property, see GroupWalk
+  struct Group
+  {
+    std::vector< std::pair< int, int > > levels; // Level and number of variable in group
+    int lastLevel = -1;
+    int nVars = 0;
+  };
+
+  /**
+   * Counts of combinations of paths that came to node, for one group.
+   * counts[mask] - paths where group variables above node have values
+   * of mask (bit j is value of j-th variable), others are not set yet.
+   */
+  template < class T >
+  struct Prefix
+  {
+    int group;
+    std::vector< T > counts;
+  };
+
+  /**
+   * Count combinations for each values of each group of variables
+   * in one top-down walk of formula nodes.
+   *
+   * Each combination goes down by edges, edge from node to its child
+   * decides node variable and all skipped variables between them
+   * (they can be anything). For each group paths carry counts of its
+   * variables values decided so far. When edge decides the last
+   * variable of group, its counts times combinations below the child
+   * (sat) are added to group result. So each combination is counted
+   * once for each group, on the edge that passes its last level.
+   *
+   * T is double for counts. With char only "is there such a path" is
+   * carried: every node except false has path to true, so nothing below
+   * is counted and result says which values of group some combination has.
+   */
+  template < class T >
+  class GroupWalk
+  {
+  public:
+    GroupWalk(const NodeGraph &g, const std::vector< Group > &groups) :
+      g_(g),
+      groups_(groups),
+      paths_(g.size(), 0),
+      prefixes_(g.size()),
+      levelGroup_(bdd_varnum(), -1),
+      touched_(groups.size(), 0),
+      counts_(groups.size())
+    {
+      if constexpr (isCounted)
+        sat_ = nodeTable::satCounts(g);
+      for (auto group : std::views::iota(0, static_cast< int >(groups.size())))
+      {
+        counts_[group].assign(std::size_t(1) << groups[group].nVars, 0);
+        for (auto [level, bit] : groups[group].levels)
+          levelGroup_[level] = group;
+      }
+    }
+
+    // Walk all edges, parents before children
+    std::vector< std::vector< T > > walk()
+    {
+      if (g_.root == g_.falseNode)
+        return counts_;
+      // Root is entered by all combinations of levels above it
+      walkEdge(0, -1, g_.root, {}, 1);
+      for (auto i : std::views::iota(0, g_.size()))
+      {
+        if (g_.lows[i] < 0)
+          continue;
+        walkEdge(g_.levels[i], 0, g_.lows[i], prefixes_[i], paths_[i]);
+        walkEdge(g_.levels[i], 1, g_.highs[i], prefixes_[i], paths_[i]);
+        std::vector< Prefix< T > >().swap(prefixes_[i]);
+      }
+      return counts_;
+    }
+
+  private:
+    static constexpr bool isCounted = std::is_same_v< T, double >;
+
+    // Add count times factor combinations to sum
+    static void add(T &sum, T count, double factor)
+    {
+      if constexpr (isCounted)
+        sum += count * factor;
+      else
+        sum |= count;
+    }
+
+    /**
+     * Edge decides levels from fromLevel to child level: the first one
+     * has value bit (none if bit is -1), others can be anything.
+     * paths - combinations that came to edge, prefixes - their counts by group.
+     */
+    void walkEdge(int fromLevel, int bit, int child, const std::vector< Prefix< T > > &prefixes, T paths)
+    {
+      if (child == g_.falseNode)
+        return;
+      auto childLevel = g_.levels[child];
+      auto nFree = childLevel - fromLevel - (bit < 0 ? 0 : 1);
+      add(paths_[child], paths, pow2(nFree));
+      std::vector< int > groups;
+      auto touch = [&](int group) {
+        if (group >= 0 and not touched_[group])
+        {
+          touched_[group] = 1;
+          groups.push_back(group);
+        }
+      };
+      for (auto &prefix : prefixes)
+        touch(prefix.group);
+      for (auto level : std::views::iota(fromLevel, childLevel))
+        touch(levelGroup_[level]);
+
+      for (auto group : groups)
+      {
+        touched_[group] = 0;
+        auto found = std::ranges::find(prefixes, group, &Prefix< T >::group);
+        std::vector< T > counts;
+        if (found != prefixes.end())
+          counts = found->counts;
+        else
+        {
+          counts.assign(counts_[group].size(), 0);
+          counts[0] = paths;
+        }
+        // Set values of group variables the edge decides
+        auto nGroupFree = 0;
+        for (auto [level, var] : groups_[group].levels)
+        {
+          if (level < fromLevel or level >= childLevel)
+            continue;
+          auto varBit = std::size_t(1) << var;
+          auto isFree = level != fromLevel or bit < 0;
+          nGroupFree += isFree;
+          for (auto mask : std::views::iota(std::size_t(0), counts.size()))
+          {
+            if (mask & varBit)
+              continue;
+            if (isFree)
+              counts[mask | varBit] = counts[mask];
+            else if (bit == 1)
+              counts[mask | varBit] = std::exchange(counts[mask], 0);
+          }
+        }
+        auto scale = pow2(nFree - nGroupFree);
+        if (groups_[group].lastLevel < childLevel)
+        {
+          for (auto mask : std::views::iota(std::size_t(0), counts.size()))
+            add(counts_[group][mask], counts[mask], isCounted ? scale * sat_[child] : 1);
+          continue;
+        }
+        auto &childPrefixes = prefixes_[child];
+        auto childPrefix = std::ranges::find(childPrefixes, group, &Prefix< T >::group);
+        if (childPrefix == childPrefixes.end())
+        {
+          childPrefixes.push_back({ group, std::vector< T >(counts.size(), 0) });
+          childPrefix = std::prev(childPrefixes.end());
+        }
+        for (auto mask : std::views::iota(std::size_t(0), counts.size()))
+          add(childPrefix->counts[mask], counts[mask], scale);
+      }
+    }
+
+    const NodeGraph &g_;
+    const std::vector< Group > &groups_;
+    std::vector< double > sat_; // Only when counted
+    std::vector< T > paths_;
+    std::vector< std::vector< Prefix< T > > > prefixes_;
+    std::vector< int > levelGroup_;
+    std::vector< char > touched_;
+    std::vector< std::vector< T > > counts_;
+  };
+
+  // Group of each object property, objNum * nProps + propNum
+  std::vector< Group > propertyGroups(BDDHelper &h)
+  {
+    std::vector< Group > groups;
+    for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+      for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+      {
+        auto vars = h.getObjPropertyVars(static_cast< Object >(objNum), static_cast< Property >(propNum));
+        Group group;
+        group.nVars = static_cast< int >(vars.size());
+        for (auto var : std::views::iota(0, group.nVars))
+        {
+          auto level = bdd_var2level(bdd_var(vars[var]));
+          group.levels.emplace_back(level, var);
+          group.lastLevel = std::max(group.lastLevel, level);
+        }
+        groups.push_back(std::move(group));
+      }
+    return groups;
+  }
+
+  // Mask of group variables values that value formula has, see Prefix
+  std::size_t valueMask(BDDHelper &h, Object obj, Property prop, int valNum)
+  {
+    auto vars = h.getObjPropertyVars(obj, prop);
+    std::size_t mask = 0;
+    for (auto [var, bit] : nodeTable::cubeLiterals(h.getObjectVal(obj, prop, valNum)))
+    {
+      auto found = std::ranges::find_if(vars, [var](const bdd &groupVar) { return bdd_var(groupVar) == var; });
+      mask |= static_cast< std::size_t >(bit) << (found - vars.begin());
+    }
+    return mask;
+  }
+
+}
+
+namespace analysis
+{
+  Marginals computeMarginals(const bdd &formula, BDDHelper &h)
+  {
+    Marginals res{};
+    auto g = nodeTable::collectNodes(formula);
+    res.total = nodeTable::satCount(g);
+    auto groups = propertyGroups(h);
+    auto counts = GroupWalk< double >(g, groups).walk();
+    for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+    {
+      auto obj = static_cast< Object >(objNum);
+      for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+      {
+        auto prop = static_cast< Property >(propNum);
+        auto &groupCounts = counts[objNum * BDDHelper::nProps + propNum];
+        for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+          res.counts[objNum][propNum][valNum] = groupCounts[valueMask(h, obj, prop, valNum)];
+      }
+    }
+    return res;
+  }
+
+  Backbone computeBackbone(const bdd &formula, BDDHelper &h)
+  {
+    Backbone res{};
+    auto g = nodeTable::collectNodes(formula);
+    auto groups = propertyGroups(h);
+    auto reachable = GroupWalk< char >(g, groups).walk();
+    for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+    {
+      auto obj = static_cast< Object >(objNum);
+      for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+      {
+        auto prop = static_cast< Property >(propNum);
+        auto &groupReachable = reachable[objNum * BDDHelper::nProps + propNum];
+        // Values of group that some combinations have. Masks that are
+        // not values (binary 1001 for example) count too: they avoid all values.
+        auto nReachable = std::ranges::count(groupReachable, 1);
+        for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+        {
+          auto possible = groupReachable[valueMask(h, obj, prop, valNum)] != 0;
+          res.impossible[objNum][propNum][valNum] = not possible;
+          res.forced[objNum][propNum][valNum] = possible and nReachable == 1;
+        }
+      }
+    }
+    return res;
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include "TestFixture.hpp"
+
+TEST_F(VarsSetupFixture, Analysis_Marginals)
+{
+  // Object properties bits are interleaved in bit sliced order
+  auto slicedVars = vect< vect< vect< bdd > > >(nObjs, vect< vect< bdd > >(nProps, vect< bdd >(nValueBits)));
+  for (auto objNum : std::views::iota(0, nObjs))
+    for (auto propNum : std::views::iota(0, nProps))
+      for (auto bit : std::views::iota(0, nValueBits))
+        slicedVars[objNum][propNum][bit] = vars[BDDHelper::varIndex(VarOrder::BIT_SLICED, objNum, propNum, bit)];
+  BDDHelper sliced(slicedVars);
+
+  for (auto *helper : { &h, &sliced })
+  {
+    auto formula = (helper->getObjectVal(Object::FIRST, Color::RED) | helper->getObjectVal(Object::SECOND, Color::RED)) &
+                   (helper->getObjectVal(Object::SECOND, Nation::CHINA) | helper->getObjectVal(Object::NINETH, Animal::CAT)) &
+                   not helper->getObjectVal(Object::FIRST, Color::GREEN);
+    auto marginals = analysis::computeMarginals(formula, *helper);
+    EXPECT_DOUBLE_EQ(marginals.total, bdd_satcount(formula));
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+        for (auto valNum : std::views::iota(0, nVals))
+        {
+          auto value = helper->getObjectVal(static_cast< Object >(objNum), static_cast< Property >(propNum), valNum);
+          EXPECT_DOUBLE_EQ(marginals.counts[objNum][propNum][valNum], bdd_satcount(formula & value));
+        }
+  }
+
+  auto empty = analysis::computeMarginals(bdd_false(), h);
+  EXPECT_EQ(empty.total, 0);
+  EXPECT_EQ(empty.counts[0][0][0], 0);
+}
+
+TEST_F(VarsSetupFixture, Analysis_Backbone)
+{
+  auto formula = h.getObjectVal(Object::THIRD, Plant::APPLE) &
+                 (h.getObjectVal(Object::FIRST, Color::RED) | h.getObjectVal(Object::FIRST, Color::GREEN)) &
+                 (h.getObjectVal(Object::SECOND, Nation::CHINA) | h.getObjectVal(Object::NINETH, Animal::CAT));
+  auto backbone = analysis::computeBackbone(formula, h);
+  EXPECT_TRUE(backbone.forced[2][2][7]);
+  EXPECT_FALSE(backbone.forced[0][0][0]);
+  EXPECT_TRUE(backbone.impossible[0][0][2]);
+  for (auto objNum : std::views::iota(0, nObjs))
+    for (auto propNum : std::views::iota(0, nProps))
+      for (auto valNum : std::views::iota(0, nVals))
+      {
+        auto value = h.getObjectVal(static_cast< Object >(objNum), static_cast< Property >(propNum), valNum);
+        EXPECT_EQ(backbone.impossible[objNum][propNum][valNum], (formula & value) == bdd_false());
+        EXPECT_EQ(backbone.forced[objNum][propNum][valNum], (formula & not value) == bdd_false());
+      }
+
+  auto empty = analysis::computeBackbone(bdd_false(), h);
+  EXPECT_TRUE(empty.impossible[0][0][0]);
+  EXPECT_FALSE(empty.forced[0][0][0]);
+}
+
+TEST_F(VarsSetupFixture, Analysis_SpreadBits)
+{
+  // Bits order: all objects properties bit 0 first, then bit 1 and so on.
+  // So other variables are between bits of each value.
+  std::vector< int > order(nTotalVars);
+  for (auto var : std::views::iota(0, nTotalVars))
+    order[(var % nValueBits) * (nTotalVars / nValueBits) + var / nValueBits] = var;
+  bdd_setvarorder(order.data());
+  auto formula = (h.getObjectVal(Object::FIRST, Color::RED) | h.getObjectVal(Object::SECOND, Color::RED)) &
+                 (h.getObjectVal(Object::SECOND, Nation::CHINA) | h.getObjectVal(Object::NINETH, Animal::CAT)) &
+                 h.getObjectVal(Object::THIRD, Plant::APPLE);
+  auto marginals = analysis::computeMarginals(formula, h);
+  auto backbone = analysis::computeBackbone(formula, h);
+  for (auto objNum : std::views::iota(0, nObjs))
+    for (auto propNum : std::views::iota(0, nProps))
+      for (auto valNum : std::views::iota(0, nVals))
+      {
+        auto value = h.getObjectVal(static_cast< Object >(objNum), static_cast< Property >(propNum), valNum);
+        EXPECT_DOUBLE_EQ(marginals.counts[objNum][propNum][valNum], bdd_satcount(formula & value));
+        EXPECT_EQ(backbone.impossible[objNum][propNum][valNum], (formula & value) == bdd_false());
+        EXPECT_EQ(backbone.forced[objNum][propNum][valNum], (formula & not value) == bdd_false());
+      }
+
+  std::ranges::copy(std::views::iota(0, nTotalVars), order.begin());
+  bdd_setvarorder(order.data());
+}
+
+#endif
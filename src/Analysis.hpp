@@ -0,0 +1,66 @@
+#ifndef ANALYSIS_HPP
+#define ANALYSIS_HPP
+
+#include <array>
+#include "bdd.h"
+#include "BDDHelper.hpp"
+
+/**
+ * Here we answer questions about ALL the suitable combinations
+ * at once, without building new formulas.
+ * We just walk nodes of result formula.
+ */
+namespace analysis
+{
+  using bddHelper::BDDHelper;
+
+  template < class T >
+  using ValuesTable = std::array< std::array< std::array< T, BDDHelper::nVals >, BDDHelper::nProps >, BDDHelper::nObjs >;
+
+  struct Marginals
+  {
+    // Count of all suitable combinations. Same as bdd_satcount.
+    double total;
+    /**
+     * counts[o][p][v] is count of suitable combinations where
+     * object o property p has value v.
+     * Same as bdd_satcount(formula & h.getObjectVal(o, p, v)).
+     */
+    ValuesTable< double > counts;
+  };
+
+  /**
+   * Count combinations for every object property value.
+   *
+   * Calling bdd_satcount(formula & value) 324 times builds 324 new formulas.
+   * Here we walk formula nodes (nodeTable::collectNodes) twice.
+   * Bottom-up we count combinations below each node. Top-down paths
+   * carry counts of values of object properties they are in the middle of,
+   * and each edge that passes the last variable of object property adds
+   * its counts to the result. With object and property orders a path is
+   * inside one object property at a time, so it's 2^bits counts per node.
+   */
+  Marginals computeMarginals(const bdd &formula, BDDHelper &h);
+
+  struct Backbone
+  {
+    // forced[o][p][v] is true if ALL suitable combinations have this value
+    ValuesTable< bool > forced;
+    // impossible[o][p][v] is true if NO suitable combination has this value
+    ValuesTable< bool > impossible;
+  };
+
+  /**
+   * Find which object property values are already determined.
+   *
+   * Instead of checking (formula & value) == bdd_false() for each value
+   * we walk formula nodes once top-down, as computeMarginals does.
+   * Each node except false has path to true, so paths carry only which
+   * values of object properties they can have, not counts. Value is
+   * possible if some path has it, and forced if no path has other bits.
+   * Nothing is counted here, so bottom-up walk is not needed.
+   */
+  Backbone computeBackbone(const bdd &formula, BDDHelper &h);
+}
+
+#endif
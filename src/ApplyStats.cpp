@@ -0,0 +1,172 @@
+#include "ApplyStats.hpp"
+#include "kernel.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <array>
+#include <ranges>
+#include <cstdint>
+
+namespace
+{
+  // Operator and operands, unused operands are -1
+  struct Operation
+  {
+    int op;
+    int left;
+    int right;
+    int third;
+
+    bool operator==(const Operation &) const = default;
+  };
+
+  struct OperationHash
+  {
+    std::size_t operator()(const Operation &operation) const
+    {
+      auto res = static_cast< std::uint64_t >(operation.op);
+      for (auto node : { operation.left, operation.right, operation.third })
+        res = res * 0x9e3779b97f4a7c15u + static_cast< std::uint32_t >(node);
+      return res ^ (res >> 29);
+    }
+  };
+
+  constexpr std::array< std::string_view, applyStats::nOps > opNames = {
+    "and", "xor", "or", "nand", "nor", "imp", "biimp", "diff", "less", "invimp", "not", "ite"
+  };
+
+  bool enabled = false;
+  bddgbchandler oldHandler = nullptr;
+  std::array< applyStats::OpStats, applyStats::nOps > counters;
+  // Operations seen since last garbage collection
+  std::unordered_set< Operation, OperationHash > sinceGbc;
+  // Operations seen since start with their results, while their nodes are alive
+  std::unordered_map< Operation, int, OperationHash > alive;
+
+  // Garbage collection puts -1 to low of freed nodes
+  bool isFreed(int node)
+  {
+    return node >= 2 and bddnodes[node].low == -1;
+  }
+
+  // Called by BuDDy before (pre = 1) and after (pre = 0) garbage collection
+  void onGbc(int pre, bddGbcStat *stat)
+  {
+    if (oldHandler)
+      oldHandler(pre, stat);
+    if (pre)
+      return;
+    sinceGbc.clear();
+    std::erase_if(alive, [](const auto &entry) {
+      auto &[operation, res] = entry;
+      return isFreed(operation.left) or isFreed(operation.right) or isFreed(operation.third) or isFreed(res);
+    });
+  }
+}
+
+namespace applyStats
+{
+  /**
+   * Forget everything and record operations from now on.
+   * BuDDy must be initialized, garbage collection hook is replaced
+   * until stop, the old one is still called.
+   */
+  void start()
+  {
+    stop();
+    sinceGbc.clear();
+    alive.clear();
+    takeStats();
+    oldHandler = bdd_gbc_hook(onGbc);
+    enabled = true;
+  }
+
+  // Stop recording, seen operations are kept until next start
+  void stop()
+  {
+    if (not enabled)
+      return;
+    bdd_gbc_hook(oldHandler);
+    oldHandler = nullptr;
+    enabled = false;
+  }
+
+  /**
+   * Operation op (bddop_*, bddop_not or opIte) was called with
+   * operands left, right and third (-1 for not used ones) and gave res.
+   * Does nothing unless started.
+   */
+  void record(int op, int left, int right, int third, int res)
+  {
+    if (not enabled or op < 0 or op >= nOps)
+      return;
+    Operation operation{ op, left, right, third };
+    auto &opStats = counters[op];
+    ++opStats.calls;
+    if (not sinceGbc.insert(operation).second)
+      ++opStats.resetHits;
+    if (auto [it, inserted] = alive.try_emplace(operation, res); not inserted and it->second == res)
+      ++opStats.keptHits;
+    else
+      it->second = res;
+  }
+
+  /**
+   * Counters of operators that were called since start or last takeStats,
+   * counters are zeroed. Seen operations are kept, so later calls
+   * still hit on them.
+   */
+  std::vector< OpStats > takeStats()
+  {
+    std::vector< OpStats > res;
+    for (auto op : std::views::iota(0, nOps))
+    {
+      if (counters[op].calls)
+      {
+        res.push_back(counters[op]);
+        res.back().name = opNames[op];
+      }
+      counters[op] = {};
+    }
+    return res;
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include "TestFixture.hpp"
+
+TEST_F(VarsSetupFixture, ApplyStats_Repeats)
+{
+  using namespace bddHelper;
+  applyStats::start();
+  auto first = h.getObjectVal(Object::FIRST, Color::RED);
+  auto second = h.getObjectVal(Object::SECOND, Color::RED);
+  auto both = first & second;
+  applyStats::record(bddop_and, first.id(), second.id(), -1, both.id());
+  applyStats::record(bddop_and, first.id(), second.id(), -1, both.id());
+  applyStats::record(bddop_not, both.id(), -1, -1, (not both).id());
+  auto stats = applyStats::takeStats();
+  ASSERT_EQ(stats.size(), 2u);
+  EXPECT_EQ(stats[0].name, "and");
+  EXPECT_EQ(stats[0].calls, 2);
+  EXPECT_EQ(stats[0].resetHits, 1);
+  EXPECT_EQ(stats[0].keptHits, 1);
+  EXPECT_EQ(stats[1].name, "not");
+  EXPECT_EQ(stats[1].resetHits, 0);
+
+  // Operands and result of "and" are alive, result of "not" is freed
+  bdd_gbc();
+  applyStats::record(bddop_and, first.id(), second.id(), -1, both.id());
+  auto negated = not both;
+  applyStats::record(bddop_not, both.id(), -1, -1, negated.id());
+  stats = applyStats::takeStats();
+  ASSERT_EQ(stats.size(), 2u);
+  EXPECT_EQ(stats[0].resetHits, 0);
+  EXPECT_EQ(stats[0].keptHits, 1);
+  EXPECT_EQ(stats[1].keptHits, 0);
+  applyStats::stop();
+  applyStats::record(bddop_and, first.id(), second.id(), -1, both.id());
+  EXPECT_TRUE(applyStats::takeStats().empty());
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef APPLY_STATS_HPP
+#define APPLY_STATS_HPP
+
+#include <vector>
+#include <string_view>
+#include "bdd.h"
+
+/**
+ * How often the same operation is asked from BuDDy again.
+ *
+ * BuDDy keeps results of operations in direct mapped caches and clears
+ * them on every garbage collection. It's prebuilt without CACHESTATS,
+ * so its hits can't be counted, and its caches can't be changed here.
+ * Instead operations that we call (bdd_apply, bdd_not and bdd_ite, not
+ * the recursive calls inside BuDDy) are recorded and repeats are counted
+ * for an ideal cache that never loses entries by collisions, with two
+ * policies on garbage collection:
+ * - reset: everything is forgotten, as BuDDy does;
+ * - kept: only operations with a freed operand or result are forgotten.
+ * bdd_bench records calls by linking with --wrap (see mainBench.cpp).
+ */
+namespace applyStats
+{
+  // bddop_* from bdd.h, bddop_not and ite
+  constexpr int opIte = bddop_not + 1;
+  constexpr int nOps = opIte + 1;
+
+  struct OpStats
+  {
+    std::string_view name;
+    long calls = 0;
+    long resetHits = 0; // Repeats since last garbage collection
+    long keptHits = 0;  // Repeats of operations whose nodes are alive
+  };
+
+  // See ApplyStats.cpp file
+  void start();
+
+  // See ApplyStats.cpp file
+  void stop();
+
+  // See ApplyStats.cpp file
+  void record(int op, int left, int right, int third, int res);
+
+  // See ApplyStats.cpp file
+  std::vector< OpStats > takeStats();
+}
+
+#endif
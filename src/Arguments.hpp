@@ -0,0 +1,77 @@
+#ifndef ARGUMENTS_HPP
+#define ARGUMENTS_HPP
+
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <algorithm>
+#include <ranges>
+#include "BDDHelper.hpp"
+#include "Conditions.hpp"
+
+/**
+ * Command line arguments of our tools.
+ * Bad argument means usage is printed, so nothing here throws.
+ */
+namespace arguments
+{
+  /**
+   * Number from argument. Whole argument must be the number:
+   * "12x", "x" and numbers that don't fit into T give nothing.
+   */
+  template < class T >
+  std::optional< T > parseNumber(std::string_view arg)
+  {
+    T value{};
+    auto end = arg.data() + arg.size();
+    auto [ptr, error] = std::from_chars(arg.data(), end, value);
+    if (error != std::errc() or ptr != end)
+      return std::nullopt;
+    return value;
+  }
+
+  // Option value names and what they mean
+  template < class T >
+  using Name = std::pair< std::string_view, T >;
+
+  // Names of variables orders for --order option, see bddHelper::VarOrder
+  constexpr Name< bddHelper::VarOrder > orderNames[] = {
+    { "object", bddHelper::VarOrder::OBJECT_MAJOR },
+    { "property", bddHelper::VarOrder::PROPERTY_MAJOR },
+    { "bits", bddHelper::VarOrder::BIT_SLICED }
+  };
+
+  // Names of encodings for --encoding option, see bddHelper::Encoding
+  constexpr Name< bddHelper::Encoding > encodingNames[] = {
+    { "binary", bddHelper::Encoding::BINARY },
+    { "fdd", bddHelper::Encoding::FDD },
+    { "onehot", bddHelper::Encoding::ONE_HOT }
+  };
+
+  // Names of uniqueness conditions for --unique option, see conditions::Uniqueness
+  constexpr Name< conditions::Uniqueness > uniquenessNames[] = {
+    { "pairwise", conditions::Uniqueness::PAIRWISE },
+    { "alldiff", conditions::Uniqueness::ALL_DIFFERENT }
+  };
+
+  // Value named arg in names, nothing if there is no such name
+  template < class T, std::size_t N >
+  std::optional< T > parseName(const Name< T > (&names)[N], std::string_view arg)
+  {
+    auto found = std::ranges::find(names, arg, &Name< T >::first);
+    if (found == std::ranges::end(names))
+      return std::nullopt;
+    return found->second;
+  }
+
+  // Name of value in names. Every value must have a name.
+  template < class T, std::size_t N >
+  std::string_view nameOf(const Name< T > (&names)[N], T value)
+  {
+    return std::ranges::find(names, value, &Name< T >::second)->first;
+  }
+}
+
+#endif
@@ -1,21 +1,311 @@
 #include "BDDFormulaBuilder.hpp"
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+#include <cstdlib>
 
-BDDFormulaBuilder::BDDFormulaBuilder() :
+namespace
+{
+  // Variables of formula, sorted.
+  std::vector< int > supportVars(const bdd &formula)
+  {
+    int *vars = nullptr;
+    int n = 0;
+    bdd_scanset(bdd_support(formula), vars, n);
+    std::vector< int > res(vars, vars + n);
+    free(vars);
+    return res;
+  }
+
+  // How many variables two sorted arrays have in common
+  std::size_t countCommon(const std::vector< int > &a, const std::vector< int > &b)
+  {
+    std::size_t count = 0;
+    for (auto ia = a.begin(), ib = b.begin(); ia != a.end() and ib != b.end();)
+    {
+      if (*ia < *ib)
+        ++ia;
+      else if (*ib < *ia)
+        ++ib;
+      else
+      {
+        ++count;
+        ++ia;
+        ++ib;
+      }
+    }
+    return count;
+  }
+}
+
+BDDFormulaBuilder::BDDFormulaBuilder(Strategy strategy) :
+  strategy_(strategy),
   formula_(bdd_true())
 {}
 
 void BDDFormulaBuilder::addCondition(bdd formula)
 {
-  formula_ &= formula;
+  pending_.push_back(formula);
 }
 
-void BDDFormulaBuilder::addConditionTh(bdd formula)
+bdd BDDFormulaBuilder::result()
 {
-  std::unique_lock lock(mut_);
-  formula_ &= formula;
+  if (pending_.empty())
+    return formula_;
+  stats_ = Stats{};
+  reorderedNodes_ = 0;
+  std::vector< bdd > formulas;
+  formulas.reserve(pending_.size() + 1);
+  formulas.push_back(formula_);
+  std::ranges::move(pending_, std::back_inserter(formulas));
+  pending_.clear();
+  stats_.nJoined = formulas.size();
+  formula_ = join(std::move(formulas));
+  stats_.resultNodes = bdd_nodecount(formula_);
+  return formula_;
 }
 
-bdd BDDFormulaBuilder::result()
+const std::vector< bdd > &BDDFormulaBuilder::pending() const
 {
-  return formula_;
+  return pending_;
+}
+
+const BDDFormulaBuilder::Stats &BDDFormulaBuilder::stats() const
+{
+  return stats_;
 }
+
+void BDDFormulaBuilder::setReorder(Reorder reorder)
+{
+  reorder_ = std::move(reorder);
+}
+
+void BDDFormulaBuilder::setTrackPeak(bool track)
+{
+  trackPeak_ = track;
+}
+
+bdd BDDFormulaBuilder::project(const bdd &keepVars)
+{
+  stats_ = Stats{};
+  reorderedNodes_ = 0;
+  std::vector< bdd > formulas;
+  formulas.reserve(pending_.size() + 1);
+  formulas.push_back(formula_);
+  formulas.insert(formulas.end(), pending_.begin(), pending_.end());
+  stats_.nJoined = formulas.size();
+
+  // After which formula each variable is not needed anymore
+  auto keep = supportVars(keepVars);
+  std::vector< int > lastUse(bdd_varnum(), -1);
+  for (auto i : std::views::iota(0, static_cast< int >(formulas.size())))
+    for (auto var : supportVars(formulas[i]))
+      lastUse[var] = i;
+  std::vector< std::vector< int > > removeAfter(formulas.size());
+  for (auto var : std::views::iota(0, bdd_varnum()))
+    if (lastUse[var] >= 0 and not std::ranges::binary_search(keep, var))
+      removeAfter[lastUse[var]].push_back(var);
+
+  // Joined part is kept in place of the last joined formula
+  noteLive(formulas);
+  auto joined = bdd_true();
+  for (auto i : std::views::iota(std::size_t(0), formulas.size()))
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto removeVars = bdd_makeset(removeAfter[i].data(), static_cast< int >(removeAfter[i].size()));
+    joined = bdd_appex(joined, formulas[i], bddop_and, removeVars);
+    stats_.seconds += std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    formulas[i] = joined;
+    if (i > 0)
+      formulas[i - 1] = bdd_true();
+    noteLive(formulas);
+  }
+  stats_.resultNodes = bdd_nodecount(joined);
+  return joined;
+}
+
+// Remember how many nodes are used by formulas that wait to be joined.
+// Reorder if they have grown enough, see setReorder.
+// Nodes are not counted if neither is needed.
+void BDDFormulaBuilder::noteLive(const std::vector< bdd > &formulas)
+{
+  if (not trackPeak_ and not reorder_)
+    return;
+  auto live = bdd_anodecount(formulas.data(), static_cast< int >(formulas.size()));
+  stats_.peakLiveNodes = std::max(stats_.peakLiveNodes, live);
+  if (reorderedNodes_ == 0)
+    reorderedNodes_ = live;
+  if (not reorder_ or live <= 2 * reorderedNodes_)
+    return;
+  reorder_(formulas);
+  reorderedNodes_ = bdd_anodecount(formulas.data(), static_cast< int >(formulas.size()));
+}
+
+/**
+ * Join formulas with & according to strategy_.
+ * Joined formulas are replaced with bdd_true() right away,
+ * so they don't take nodes anymore.
+ */
+bdd BDDFormulaBuilder::join(std::vector< bdd > formulas)
+{
+  auto joinTwo = [this](const bdd &a, const bdd &b) {
+    auto start = std::chrono::steady_clock::now();
+    auto res = a & b;
+    stats_.seconds += std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    return res;
+  };
+  noteLive(formulas);
+  switch (strategy_)
+  {
+    case Strategy::SEQUENTIAL:
+      for (auto i : std::views::iota(std::size_t(1), formulas.size()))
+      {
+        formulas[0] = joinTwo(formulas[0], formulas[i]);
+        formulas[i] = bdd_true();
+        noteLive(formulas);
+      }
+      break;
+
+    case Strategy::SUPPORT_CLUSTER:
+    {
+      // Joined part is formulas[0]. Next goes the formula with the biggest
+      // part of its variables already there, smaller first for equal parts.
+      // Such formula only restricts what is joined, so the result shrinks.
+      // Joining formulas about other variables first (pairs, smallest ones)
+      // builds all-different constraints without any hints for this puzzle,
+      // and they don't finish.
+      std::vector< int > sizes;
+      std::vector< std::vector< int > > supports;
+      for (auto &formula : formulas)
+      {
+        sizes.push_back(bdd_nodecount(formula));
+        supports.push_back(supportVars(formula));
+      }
+      while (formulas.size() > 1)
+      {
+        std::size_t next = 1;
+        double bestShare = -1;
+        for (auto i : std::views::iota(std::size_t(1), formulas.size()))
+        {
+          auto share = supports[i].empty() ? 1.0 :
+            static_cast< double >(countCommon(supports[0], supports[i])) / supports[i].size();
+          if (share > bestShare or (share == bestShare and sizes[i] < sizes[next]))
+          {
+            next = i;
+            bestShare = share;
+          }
+        }
+        formulas[0] = joinTwo(formulas[0], formulas[next]);
+        std::vector< int > joinedSupport;
+        std::ranges::set_union(supports[0], supports[next], std::back_inserter(joinedSupport));
+        supports[0] = std::move(joinedSupport);
+        formulas.erase(formulas.begin() + next);
+        sizes.erase(sizes.begin() + next);
+        supports.erase(supports.begin() + next);
+        noteLive(formulas);
+      }
+      break;
+    }
+  }
+  return formulas[0];
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include "TestFixture.hpp"
+#include <cmath>
+#include "Conditions.hpp"
+
+TEST_F(VarsSetupFixture, FormulaBuilder_Strategies)
+{
+  using namespace bddHelper;
+  using Strategy = BDDFormulaBuilder::Strategy;
+  // Small conditions set: colors of three objects are all different and valid
+  auto addColors = [this](BDDFormulaBuilder &builder) {
+    auto objs = { Object::FIRST, Object::SECOND, Object::THIRD };
+    for (auto obj : objs)
+    {
+      auto valid = bdd_false();
+      for (auto valNum : std::views::iota(0, nVals))
+        valid |= h.getObjectVal(obj, Property::COLOR, valNum);
+      builder.addCondition(valid);
+    }
+    for (auto valNum : std::views::iota(0, nVals))
+    {
+      builder.addCondition(not (h.getObjectVal(Object::FIRST, Property::COLOR, valNum) & h.getObjectVal(Object::SECOND, Property::COLOR, valNum)));
+      builder.addCondition(not (h.getObjectVal(Object::FIRST, Property::COLOR, valNum) & h.getObjectVal(Object::THIRD, Property::COLOR, valNum)));
+      builder.addCondition(not (h.getObjectVal(Object::SECOND, Property::COLOR, valNum) & h.getObjectVal(Object::THIRD, Property::COLOR, valNum)));
+    }
+    builder.addCondition(h.getObjectVal(Object::SECOND, Color::RED));
+  };
+  BDDFormulaBuilder sequential(Strategy::SEQUENTIAL);
+  sequential.setTrackPeak(true);
+  addColors(sequential);
+  auto expected = sequential.result();
+  // SECOND is red, FIRST and THIRD take any other 2 of 8 colors
+  EXPECT_EQ(bdd_satcount(expected), 8 * 7 * std::pow(2.0, nTotalVars - 3 * nValueBits));
+  EXPECT_EQ(sequential.stats().nJoined, 3 + 3 * nVals + 1 + 1);
+  EXPECT_GE(sequential.stats().peakLiveNodes, sequential.stats().resultNodes);
+  BDDFormulaBuilder cluster(Strategy::SUPPORT_CLUSTER);
+  cluster.setTrackPeak(true);
+  addColors(cluster);
+  EXPECT_EQ(cluster.result(), expected);
+  EXPECT_EQ(cluster.stats().resultNodes, bdd_nodecount(expected));
+  EXPECT_GE(cluster.stats().peakLiveNodes, cluster.stats().resultNodes);
+  // Nothing new to join - same formula
+  EXPECT_EQ(cluster.result(), expected);
+
+  // Peak is not tracked by default
+  BDDFormulaBuilder untracked(Strategy::SUPPORT_CLUSTER);
+  addColors(untracked);
+  EXPECT_EQ(untracked.result(), expected);
+  EXPECT_EQ(untracked.stats().peakLiveNodes, 0);
+}
+
+TEST_F(VarsSetupFixture, FormulaBuilder_Reorder)
+{
+  // Colors of FIRST and FOURTH are equal, and so are colors of SECOND and THIRD.
+  // Each equality is small, but in objects order they are big together.
+  auto firstFourth = bdd_true();
+  auto secondThird = bdd_true();
+  for (auto bit : std::views::iota(0, nValueBits))
+  {
+    firstFourth &= bdd_biimp(v[0][0][bit], v[3][0][bit]);
+    secondThird &= bdd_biimp(v[1][0][bit], v[2][0][bit]);
+  }
+  BDDFormulaBuilder builder;
+  builder.addCondition(firstFourth);
+  builder.addCondition(secondThird);
+  std::vector< std::vector< bdd > > calls;
+  builder.setReorder([&calls](const std::vector< bdd > &formulas) {
+    calls.push_back(formulas);
+  });
+  auto joined = firstFourth & secondThird;
+  ASSERT_GT(bdd_nodecount(joined), 2 * (bdd_nodecount(firstFourth) + bdd_nodecount(secondThird)));
+  EXPECT_EQ(builder.result(), joined);
+  // Called once, when formulas have grown, with joined formula in place of the first one
+  ASSERT_EQ(calls.size(), 1);
+  EXPECT_EQ(calls[0][0], joined);
+}
+
+TEST_F(VarsSetupFixture, FormulaBuilder_Project)
+{
+  using namespace bddHelper;
+  BDDFormulaBuilder builder;
+  builder.setTrackPeak(true);
+  conditions::addConditions(h, builder);
+  auto nations = builder.project(h.getPropertyVarSet(Property::NATION));
+  EXPECT_GE(builder.stats().peakLiveNodes, builder.stats().resultNodes);
+  auto others = h.getPropertyVarSet(Property::COLOR) & h.getPropertyVarSet(Property::PLANT) &
+                h.getPropertyVarSet(Property::ANIMAL);
+  auto formula = builder.result();
+  EXPECT_EQ(nations, bdd_exist(formula, others));
+  // Nothing is removed
+  auto allVars = others & h.getPropertyVarSet(Property::NATION);
+  EXPECT_EQ(builder.project(allVars), formula);
+  // Everything is removed
+  EXPECT_EQ(builder.project(bdd_true()), bdd_true());
+}
+
+#endif
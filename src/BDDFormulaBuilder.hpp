@@ -2,32 +2,97 @@
 #define BDD_FORMULA_BUILDER_HPP
 
 #include "bdd.h"
-#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <functional>
 
 class BDDFormulaBuilder
 {
 public:
+  /**
+   * How conditions are joined together (with &) in result().
+   * Result is the same, but formulas we get in the middle
+   * may be much bigger with one strategy than with another.
+   */
+  enum class Strategy
+  {
+    SEQUENTIAL,      // One by one in order they were added
+    SUPPORT_CLUSTER  // Next is the one that has most of its variables already joined
+  };
+
+  // What happened in last result() or project() call.
+  struct Stats
+  {
+    std::size_t nJoined = 0; // How many formulas were joined
+    int peakLiveNodes = 0;   // Max nodes used by all formulas waiting to be joined, see setTrackPeak
+    int resultNodes = 0;     // Nodes in result (or projected) formula
+    double seconds = 0;      // Time spent on joining
+  };
+
+  // Gets formulas that wait to be joined, may reorder variables
+  using Reorder = std::function< void(const std::vector< bdd > &formulas) >;
+
   /**
    * Create empty formula.
    * Later we will add conditions using addCondition.
    */
-  BDDFormulaBuilder();
+  BDDFormulaBuilder(Strategy strategy = Strategy::SEQUENTIAL);
   /**
    * Adds condition to formula.
+   * Condition is not joined right now, it waits for result() call.
    */
   void addCondition(bdd formula);
-  /**
-   * Same as previous, but thread safe.
-   */
-  void addConditionTh(bdd formula);
   /**
    * Return result bdd conditions formula.
+   * Here all the added conditions are joined using strategy.
    */
   bdd result();
+  /**
+   * Return conditions formula where all variables except keepVars
+   * are removed with exists. Other words, formula tells which keepVars
+   * values are part of some suitable combination.
+   * keepVars is variables set (see bdd_makeset).
+   *
+   * Result formula of all conditions is NOT built here. Conditions are
+   * joined one by one in order they were added, and each variable we don't
+   * keep is removed right after the last condition that has it is joined.
+   * bdd_appex does join and exists in one pass, so formulas in the middle
+   * never have variables nobody needs anymore.
+   * Conditions are kept, so result() and other projections still work.
+   */
+  bdd project(const bdd &keepVars);
+  /**
+   * Conditions that are added but not joined yet.
+   */
+  const std::vector< bdd > &pending() const;
+  /**
+   * Statistics of the last joining.
+   */
+  const Stats &stats() const;
+  /**
+   * Call reorder each time formulas waiting to be joined take twice
+   * as many nodes as when joining started, or as right after
+   * the previous call. See BDDHelper::siftGroups.
+   */
+  void setReorder(Reorder reorder);
+  /**
+   * Count nodes of all formulas waiting to be joined after each join
+   * and keep the max in Stats::peakLiveNodes. It walks all of them
+   * every time, so it is off by default and peakLiveNodes is 0.
+   */
+  void setTrackPeak(bool track);
 
 private:
+  bdd join(std::vector< bdd > formulas);
+  void noteLive(const std::vector< bdd > &formulas);
+
+  Strategy strategy_;
   bdd formula_;
-  std::mutex mut_;
+  std::vector< bdd > pending_;
+  Stats stats_;
+  Reorder reorder_;
+  int reorderedNodes_ = 0;  // Live nodes at start or after the last reorder_ call
+  bool trackPeak_ = false;
 };
 
 #endif
@@ -1,22 +1,56 @@
 #include "BDDHelper.hpp"
+#include "LevelTable.hpp"
 #include <expected>
 #include <utility>
 #include <algorithm>
 #include <ranges>
+#include <chrono>
+#include <cstdlib>
+
+namespace
+{
+  bddHelper::BDDHelper::ReorderStats reorderStats_;
+  std::chrono::steady_clock::time_point reorderStart_;
+
+  // Called by BuDDy right before (prestate is 1) and after (0) reordering
+  void reorderHook(int prestate)
+  {
+    if (prestate)
+    {
+      reorderStats_.nodesBefore += bdd_getnodenum();
+      reorderStart_ = std::chrono::steady_clock::now();
+      return;
+    }
+    reorderStats_.seconds += std::chrono::duration< double >(std::chrono::steady_clock::now() - reorderStart_).count();
+    reorderStats_.nodesAfter += bdd_getnodenum();
+    ++reorderStats_.nReorders;
+  }
+
+  // True if variables occupy levels next to each other
+  bool areNeighbours(const std::vector< int > &varNums)
+  {
+    auto levels = varNums | std::views::transform([](int var) { return bdd_var2level(var); });
+    auto [lo, hi] = std::ranges::minmax(levels);
+    return hi - lo + 1 == static_cast< int >(varNums.size());
+  }
+}
 
 namespace bddHelper
 {
   /**
    * We have seen structedVars in main.cpp
+   * With ONE_HOT encoding structedVars[obj][prop] has variable
+   * for each value instead of bits.
    */
-  BDDHelper::BDDHelper(vect< vect< vect< bdd > > > structedVars) :
-    structVars_(std::move(structedVars))
+  BDDHelper::BDDHelper(vect< vect< vect< bdd > > > structedVars, Encoding encoding) :
+    structVars_(std::move(structedVars)),
+    encoding_(encoding)
   {
     // Check the sizes to be sure we haven't made a mistake yet...
     assert(("Incorrect size found",
             structVars_.size() == nObjs and
             structVars_[0].size() == nProps and
-            structVars_[0][0].size() == nValueBits));
+            static_cast< int >(structVars_[0][0].size()) == nGroupVars()));
     /**
      * If we want to say, that second object's third property 
      * MUST have value 5 - we would say
@@ -37,15 +71,153 @@ namespace bddHelper
       values_[objNum] = vect< vect< bdd > >(nProps);
       for (auto propNum : std::views::iota(0, nProps))
       {
+        if (encoding_ == Encoding::ONE_HOT)
+        {
+          values_[objNum][propNum] = oneHotValues(structVars_[objNum][propNum]);
+          continue;
+        }
         values_[objNum][propNum] = vect< bdd > (nVals);
+        // FDD values are made by fdd_ithvar, see withFdd
+        if (encoding_ == Encoding::FDD)
+          continue;
         for (auto valNum : std::views::iota(0, nVals))
-        {
           values_[objNum][propNum][valNum] = numToBin(valNum, structVars_[objNum][propNum]);
-        }
       }
     }
   }
 
+  /**
+   * Number of bdd variable for bit of object property value.
+   * Use it to fill structedVars. Conditions don't care about it,
+   * they get variables from structedVars only.
+   * nGroupVars is nVals for ONE_HOT encoding, then "bit" is value
+   * and BIT_SLICED places one value of all objects together.
+   */
+  int BDDHelper::varIndex(VarOrder order, int objNum, int propNum, int bit, int nGroupVars)
+  {
+    switch (order)
+    {
+      case VarOrder::OBJECT_MAJOR:   return (objNum * nProps + propNum) * nGroupVars + bit;
+      case VarOrder::PROPERTY_MAJOR: return (propNum * nObjs + objNum) * nGroupVars + bit;
+      case VarOrder::BIT_SLICED:     return (propNum * nGroupVars + bit) * nObjs + objNum;
+    }
+    assert(("Bad enum value", false));
+    std::unreachable();
+  }
+
+  /**
+   * Create nTotalVars new variables and helper with binary encoding on them.
+   * Variables are placed according to order, see varIndex.
+   */
+  BDDHelper BDDHelper::withBinary(VarOrder order)
+  {
+    auto first = bdd_extvarnum(nTotalVars);
+    auto structedVars = vect< vect< vect< bdd > > >(nObjs, vect< vect< bdd > >(nProps, vect< bdd >(nValueBits)));
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+        for (auto bit : std::views::iota(0, nValueBits))
+          structedVars[objNum][propNum][bit] = bdd_ithvar(first + varIndex(order, objNum, propNum, bit));
+    return BDDHelper(structedVars);
+  }
+
+  /**
+   * Create FDD domain of 9 values for each object property
+   * and helper on them. fdd_extdomain creates variables itself.
+   * Domains created in one call have their bits interleaved,
+   * so for BIT_SLICED order we create all objects of property at once.
+   *
+   * FDD has least significant bit first, we have it last.
+   * So bits are reversed in structVars_, then values are read from
+   * solutions the same way as binary ones and printing doesn't have to know about FDD.
+   */
+  BDDHelper BDDHelper::withFdd(VarOrder order)
+  {
+    vect< vect< int > > domains(nObjs, vect< int >(nProps));
+    auto extend = [](int nDomains) {
+      std::vector< int > sizes(nDomains, nVals);
+      auto first = fdd_extdomain(sizes.data(), nDomains);
+      assert(("Can't create FDD domain", first >= 0));
+      return first;
+    };
+    switch (order)
+    {
+      case VarOrder::OBJECT_MAJOR:
+        for (auto objNum : std::views::iota(0, nObjs))
+          for (auto propNum : std::views::iota(0, nProps))
+            domains[objNum][propNum] = extend(1);
+        break;
+      case VarOrder::PROPERTY_MAJOR:
+        for (auto propNum : std::views::iota(0, nProps))
+          for (auto objNum : std::views::iota(0, nObjs))
+            domains[objNum][propNum] = extend(1);
+        break;
+      case VarOrder::BIT_SLICED:
+        for (auto propNum : std::views::iota(0, nProps))
+        {
+          auto first = extend(nObjs);
+          for (auto objNum : std::views::iota(0, nObjs))
+            domains[objNum][propNum] = first + objNum;
+        }
+        break;
+    }
+    auto structedVars = vect< vect< vect< bdd > > >(nObjs, vect< vect< bdd > >(nProps));
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+      {
+        auto domain = domains[objNum][propNum];
+        assert(("Domain of 9 values must have 4 bits", fdd_varnum(domain) == nValueBits));
+        auto domainVars = fdd_vars(domain);
+        for (auto bit : std::views::iota(0, nValueBits) | std::views::reverse)
+          structedVars[objNum][propNum].push_back(bdd_ithvar(domainVars[bit]));
+      }
+    BDDHelper h(structedVars, Encoding::FDD);
+    h.domains_ = std::move(domains);
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+        for (auto valNum : std::views::iota(0, nVals))
+          h.values_[objNum][propNum][valNum] = fdd_ithvar(h.domains_[objNum][propNum], valNum);
+    return h;
+  }
+
+  /**
+   * Create variable for each object property value and helper on them.
+   * It's 324 variables instead of 144, but uniqueness of values
+   * is 36 "exactly one object" conditions instead of 144 pairs,
+   * see conditions::addUniqueCondition.
+   */
+  BDDHelper BDDHelper::withOneHot(VarOrder order)
+  {
+    auto first = bdd_extvarnum(nObjs * nProps * nVals);
+    auto structedVars = vect< vect< vect< bdd > > >(nObjs, vect< vect< bdd > >(nProps, vect< bdd >(nVals)));
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+        for (auto valNum : std::views::iota(0, nVals))
+          structedVars[objNum][propNum][valNum] = bdd_ithvar(first + varIndex(order, objNum, propNum, valNum, nVals));
+    return BDDHelper(structedVars, Encoding::ONE_HOT);
+  }
+
+  Encoding BDDHelper::encoding() const
+  {
+    return encoding_;
+  }
+
+  int BDDHelper::nGroupVars() const
+  {
+    return encoding_ == Encoding::ONE_HOT ? nVals : nValueBits;
+  }
+
+  int BDDHelper::nVars() const
+  {
+    return nObjs * nProps * nGroupVars();
+  }
+
+  // See BDDHelper.hpp
+  bdd BDDHelper::getObjectVal(Object obj, Property prop, int valNum)
+  {
+    assert(("Bad value", valNum >= 0 and valNum < nVals));
+    return values_[toNum(obj)][toNum(prop)][valNum];
+  }
+
   /**
    * Just return variables that describe Object's obj Property prop.
    * For example getObjPropertyVars(Object::SECOND, Property::Color)
@@ -58,6 +230,242 @@ namespace bddHelper
     return structVars_[objNum][propNum];
   }
 
+  /**
+   * Variables of Property prop of ALL the objects as variables set.
+   * For example getPropertyVarSet(Property::NATION) is what we keep
+   * when we want to know only where nations live.
+   */
+  bdd BDDHelper::getPropertyVarSet(Property prop)
+  {
+    auto propNum = toNum(prop);
+    std::vector< int > varNums;
+    for (auto &objVars : structVars_)
+      for (auto &var : objVars[propNum])
+        varNums.push_back(bdd_var(var));
+    return bdd_makeset(varNums.data(), static_cast< int >(varNums.size()));
+  }
+
+  /**
+   * Number of variable that is bit of Object's obj Property prop value.
+   * Nothing is copied here, so it's fine to call it from several threads.
+   */
+  int BDDHelper::getVarNum(Object obj, Property prop, int bit) const
+  {
+    return bdd_var(structVars_[toNum(obj)][toNum(prop)][bit]);
+  }
+
+  /**
+   * Value number of Object's obj Property prop in solution.
+   * varset[i] is value (0 or 1) of variable i, see solutions::VarSet.
+   * Solutions of our conditions always have a value, so with ONE_HOT
+   * encoding varset where no value variable is set means a bug: we abort.
+   */
+  int BDDHelper::getValNum(Object obj, Property prop, const std::string &varset) const
+  {
+    if (encoding_ == Encoding::ONE_HOT)
+    {
+      for (auto valNum : std::views::iota(0, nVals))
+        if (varset.at(getVarNum(obj, prop, valNum)))
+          return valNum;
+      assert(("Object property has no value", false));
+      std::abort();
+    }
+    int valNum = 0;
+    for (auto bit : std::views::iota(0, nValueBits))
+      valNum = (valNum << 1) + varset.at(getVarNum(obj, prop, bit));
+    return valNum;
+  }
+
+  /**
+   * Place groups on levels one after another: first group gets
+   * levels 0..3, second one 4..7 and so on. Bits keep their order inside group.
+   * groups must contain each object property exactly once.
+   * Order is given by objects and properties, not by variable numbers,
+   * so it means the same with any VarOrder.
+   * Variable blocks must not be added yet - BuDDy refuses to set order then.
+   * Variables that are not ours (dualModel::DualModel for example)
+   * go after groups and keep their order.
+   */
+  void BDDHelper::setGroupOrder(const std::vector< Group > &groups)
+  {
+    assert(("Each object property must be given once", groups.size() == nObjs * nProps));
+    std::vector< int > order;
+    order.reserve(bdd_varnum());
+    std::vector< char > isOurs(bdd_varnum(), 0);
+    for (auto [obj, prop] : groups)
+      for (auto bit : std::views::iota(0, nGroupVars()))
+      {
+        order.push_back(getVarNum(obj, prop, bit));
+        isOurs[order.back()] = 1;
+      }
+    for (auto level : std::views::iota(0, bdd_varnum()))
+      if (not isOurs[bdd_level2var(level)])
+        order.push_back(bdd_level2var(level));
+    bdd_setvarorder(order.data());
+  }
+
+  // Groups sorted by level of their first bit
+  std::vector< BDDHelper::Group > BDDHelper::getGroupOrder() const
+  {
+    std::vector< std::pair< int, Group > > byLevel;
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+      {
+        auto group = Group{ static_cast< Object >(objNum), static_cast< Property >(propNum) };
+        byLevel.emplace_back(bdd_var2level(getVarNum(group.first, group.second, 0)), group);
+      }
+    std::ranges::sort(byLevel, {}, &std::pair< int, Group >::first);
+    std::vector< Group > groups;
+    for (auto &[level, group] : byLevel)
+      groups.push_back(group);
+    return groups;
+  }
+
+  /**
+   * Tell BuDDy which variables must stay together when it reorders them.
+   * Bits of one object property are a FIXED block: they move only together
+   * and keep their order, so numToBin and printing still work.
+   * Above them there are free blocks of one object (or one property - it
+   * depends on VarOrder), inside of which property blocks can be sifted.
+   * Block can be made only of variables that are next to each other now,
+   * so with BIT_SLICED order only property blocks are made.
+   * Without any block BuDDy never reorders automatically.
+   */
+  void BDDHelper::addVarBlocks()
+  {
+    auto addBlock = [](std::vector< int > varNums, int fixed) {
+      if (areNeighbours(varNums))
+        bdd_addvarblock(bdd_makeset(varNums.data(), static_cast< int >(varNums.size())), fixed);
+    };
+    for (auto objNum : std::views::iota(0, nObjs))
+    {
+      std::vector< int > objVars;
+      for (auto &propVars : structVars_[objNum])
+        for (auto &var : propVars)
+          objVars.push_back(bdd_var(var));
+      addBlock(objVars, BDD_REORDER_FREE);
+    }
+    for (auto propNum : std::views::iota(0, nProps))
+    {
+      std::vector< int > propVars;
+      for (auto &objVars : structVars_)
+        for (auto &var : objVars[propNum])
+          propVars.push_back(bdd_var(var));
+      addBlock(propVars, BDD_REORDER_FREE);
+    }
+    for (auto objNum : std::views::iota(0, nObjs))
+    {
+      for (auto propNum : std::views::iota(0, nProps))
+      {
+        std::vector< int > groupVars;
+        for (auto &var : structVars_[objNum][propNum])
+          groupVars.push_back(bdd_var(var));
+        // FDD domain is exactly the group, BuDDy knows its variables
+        if (encoding_ == Encoding::FDD and areNeighbours(groupVars))
+          fdd_intaddvarblock(domains_[objNum][propNum], domains_[objNum][propNum], BDD_REORDER_FIXED);
+        else
+          addBlock(groupVars, BDD_REORDER_FIXED);
+      }
+    }
+  }
+
+  /**
+   * Let BuDDy reorder variables when node table is full, using method
+   * (BDD_REORDER_SIFT, BDD_REORDER_WIN3ITE...), but no more than maxTimes.
+   * Call addVarBlocks before. Statistics are collected from here on.
+   * Don't create formulas from several threads while reordering is enabled.
+   */
+  void BDDHelper::enableReorder(int method, int maxTimes)
+  {
+    reorderStats_ = ReorderStats{};
+    bdd_reorder_hook(reorderHook);
+    bdd_autoreorder_times(method, maxTimes);
+  }
+
+  // Variables order stays as it is now
+  void BDDHelper::disableReorder()
+  {
+    bdd_autoreorder(BDD_REORDER_NONE);
+  }
+
+  const BDDHelper::ReorderStats &BDDHelper::reorderStats()
+  {
+    return reorderStats_;
+  }
+
+  /**
+   * Sift variables over nodes of formulas without BuDDy reordering:
+   * nodes are copied to levelTable::LevelTable, where swap of two levels
+   * costs as many nodes as they have, and found order is set once.
+   * Blocks are the same as fixed ones of addVarBlocks: bits of one object
+   * property, or of one property if they are not next to each other
+   * (BIT_SLICED). Variables that are not ours are not moved.
+   * Like setGroupOrder, it can't be used after addVarBlocks.
+   * Statistics go to reorderStats, as for BuDDy reorderings.
+   */
+  void BDDHelper::siftGroups(const std::vector< bdd > &formulas)
+  {
+    auto start = std::chrono::steady_clock::now();
+    levelTable::LevelTable table(formulas);
+    reorderStats_.nodesBefore += table.size();
+
+    std::vector< std::vector< int > > groupVars;
+    std::vector< std::vector< int > > propVars(nProps);
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+      {
+        groupVars.emplace_back();
+        for (auto &var : structVars_[objNum][propNum])
+          groupVars.back().push_back(bdd_var(var));
+        std::ranges::copy(groupVars.back(), std::back_inserter(propVars[propNum]));
+      }
+    auto isBlock = [](const std::vector< int > &vars) {
+      return areNeighbours(vars) and std::ranges::is_sorted(vars, {}, bdd_var2level);
+    };
+    // Size of block that starts on level, if there is one
+    std::vector< int > blockAt(bdd_varnum(), 0);
+    for (auto &vars : std::ranges::all_of(groupVars, isBlock) ? groupVars : propVars)
+      if (areNeighbours(vars))
+        blockAt[std::ranges::min(vars | std::views::transform(bdd_var2level))] = static_cast< int >(vars.size());
+    std::vector< levelTable::Block > blocks;
+    for (int level = 0; level < bdd_varnum();)
+    {
+      if (blockAt[level])
+        blocks.push_back({ blockAt[level], true });
+      else
+        blocks.push_back({ 1, false });
+      level += blocks.back().nLevels;
+    }
+
+    levelTable::siftBlocks(table, blocks);
+    auto order = table.order();
+    bdd_setvarorder(order.data());
+    reorderStats_.nodesAfter += table.size();
+    reorderStats_.seconds += std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    ++reorderStats_.nReorders;
+  }
+
+  /**
+   * Conditions that forbid codes that are not values.
+   * 4 bits have 16 codes, but we have only 9 values.
+   * With binary encoding it's 7 conditions: NOT 9, NOT 10... NOT 15,
+   * see notNumToBin.
+   * With FDD it's one condition, fdd_domain says value is less than 9.
+   * With ONE_HOT there are no extra codes, but exactly one value
+   * variable must be true.
+   */
+  std::vector< bdd > BDDHelper::getValueBounds(Object obj, Property prop)
+  {
+    if (encoding_ == Encoding::FDD)
+      return { fdd_domain(domains_[toNum(obj)][toNum(prop)]) };
+    if (encoding_ == Encoding::ONE_HOT)
+      return { exactlyOne(getObjPropertyVars(obj, prop)) };
+    std::vector< bdd > bounds;
+    for (auto code : std::views::iota(nVals, 1 << nValueBits))
+      bounds.push_back(notNumToBin(code, getObjPropertyVars(obj, prop)));
+    return bounds;
+  }
+
   // See BDDHelper::numToBinUnsafe - right the next
   bdd BDDHelper::numToBin(int num, vect< bdd > vars)
   {
@@ -93,6 +501,71 @@ namespace bddHelper
     return resFormula;
   }
 
+  /**
+   * Same as not numToBinUnsafe(num, vars), but without negating whole cube.
+   * Value is not num when any of its bits differs:
+   * notNumToBin(9, {a, b, c, d}) is !a | b | c | !d because 9 is 1001
+   */
+  bdd BDDHelper::notNumToBin(int num, const vect< bdd > &vars)
+  {
+    assert(vars.size() == 4);
+    assert(num >= 0 and num <= 15);
+    auto resFormula = bdd_false();
+    auto currentNum = num;
+    for (auto &var : std::views::reverse(vars))
+    {
+      auto bit = currentNum % 2;
+      currentNum /= 2;
+      resFormula |= bit == 1 ? not var : var;
+    }
+    return resFormula;
+  }
+
+  /**
+   * Values of ONE_HOT encoded vars: value i is var i true, others false.
+   * Only its variable would be enough together with getValueBounds,
+   * but conditions are joined before bounds, and without others being false
+   * formula grows to millions of nodes. Like numToBin, all variables are fixed.
+   * Cubes of two values differ only in two literals, so building them
+   * one by one repeats the same products of negated variables
+   * (bdd_bench --apply-stats counts them). Here each value is
+   *    (none of vars before it) & its var & (none of vars after it),
+   * and "none before" and "none after" are built once for all values.
+   */
+  std::vector< bdd > BDDHelper::oneHotValues(const vect< bdd > &vars)
+  {
+    auto nVars = vars.size();
+    // noneBefore[i] - none of vars[0..i) is true, noneAfter[i] - none of vars[i..n)
+    std::vector< bdd > noneBefore(nVars + 1, bdd_true());
+    std::vector< bdd > noneAfter(nVars + 1, bdd_true());
+    for (auto i : std::views::iota(std::size_t(0), nVars))
+    {
+      noneBefore[i + 1] = noneBefore[i] & not vars[i];
+      noneAfter[nVars - i - 1] = noneAfter[nVars - i] & not vars[nVars - i - 1];
+    }
+    std::vector< bdd > values;
+    for (auto i : std::views::iota(std::size_t(0), nVars))
+      values.push_back(noneBefore[i] & vars[i] & noneAfter[i + 1]);
+    return values;
+  }
+
+  /**
+   * Exactly one of vars is true.
+   * We go through vars keeping two formulas: none of vars so far is true,
+   * and exactly one of them is true. So it's linear, not n^2 "not both" pairs.
+   */
+  bdd BDDHelper::exactlyOne(const vect< bdd > &vars)
+  {
+    auto none = bdd_true();
+    auto one = bdd_false();
+    for (auto &var : vars)
+    {
+      one = bdd_ite(var, none, one);
+      none &= not var;
+    }
+    return one;
+  }
+
   // See BDDHelper.hpp
   int toNum(Property value)
   {
@@ -106,6 +579,7 @@ namespace bddHelper
 
 #include <gtest/gtest.h>
 #include <ranges>
+#include <numeric>
 #include "TestFixture.hpp"
 
 bddHelper::BDDHelper::BDDHelper()
@@ -124,4 +598,168 @@ TEST_F(VarsSetupFixture, BDDHelperbasic)
     not v[1][3][0] & v[1][3][1] & v[1][3][2] & not v[1][3][3]);
 }
 
+TEST_F(VarsSetupFixture, BDDHelper_NotNumToBin)
+{
+  using namespace bddHelper;
+  for (auto num : std::views::iota(0, 1 << nValueBits))
+    EXPECT_EQ(h.notNumToBin(num, v[3][2]), not h.numToBinUnsafe(num, v[3][2]));
+}
+
+TEST_F(VarsSetupFixture, BDDHelper_OneHotValues)
+{
+  using namespace bddHelper;
+  auto values = h.oneHotValues(v[5][1]);
+  ASSERT_EQ(values.size(), v[5][1].size());
+  for (auto valNum : std::views::iota(0, static_cast< int >(values.size())))
+  {
+    auto cube = bdd_true();
+    for (auto varNum : std::views::iota(0, static_cast< int >(values.size())))
+      cube &= varNum == valNum ? v[5][1][varNum] : not v[5][1][varNum];
+    EXPECT_EQ(values[valNum], cube);
+  }
+}
+
+TEST_F(VarsSetupFixture, BDDHelper_VarOrder)
+{
+  using namespace bddHelper;
+  for (auto order : { VarOrder::OBJECT_MAJOR, VarOrder::PROPERTY_MAJOR, VarOrder::BIT_SLICED })
+  {
+    // Each variable is used exactly once
+    std::vector< int > used(nTotalVars, 0);
+    auto structedVars = vect< vect< vect< bdd > > >(nObjs, vect< vect< bdd > >(nProps, vect< bdd >(nValueBits)));
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+        for (auto bit : std::views::iota(0, nValueBits))
+        {
+          auto index = BDDHelper::varIndex(order, objNum, propNum, bit);
+          ASSERT_TRUE(index >= 0 and index < nTotalVars);
+          ++used[index];
+          structedVars[objNum][propNum][bit] = vars[index];
+        }
+    EXPECT_EQ(std::ranges::count(used, 1), nTotalVars);
+    BDDHelper helper(structedVars);
+    EXPECT_EQ(helper.getVarNum(Object::SECOND, Property::NATION, 3), BDDHelper::varIndex(order, 1, 1, 3));
+    EXPECT_EQ(helper.getObjectVal(Object::THIRD, Color::BLUE),
+      not structedVars[2][0][0] & not structedVars[2][0][1] & structedVars[2][0][2] & not structedVars[2][0][3]);
+  }
+  // Fixture variables are in object major order
+  EXPECT_EQ(BDDHelper::varIndex(VarOrder::OBJECT_MAJOR, 1, 2, 3), bdd_var(v[1][2][3]));
+}
+
+TEST_F(VarsSetupFixture, BDDHelper_GroupOrder)
+{
+  using namespace bddHelper;
+  auto formula = h.getObjectVal(Object::FIRST, Color::BLUE) & h.getObjectVal(Object::NINETH, Animal::CAT);
+  auto count = bdd_satcount(formula);
+  auto groups = h.getGroupOrder();
+  ASSERT_EQ(groups.size(), nObjs * nProps);
+  EXPECT_EQ(groups.front(), BDDHelper::Group(Object::FIRST, Property::COLOR));
+  std::ranges::reverse(groups);
+  h.setGroupOrder(groups);
+  EXPECT_EQ(h.getGroupOrder(), groups);
+  EXPECT_EQ(bdd_var2level(bdd_var(v[nObjs - 1][nProps - 1][0])), 0);
+  EXPECT_EQ(bdd_var2level(bdd_var(v[nObjs - 1][nProps - 1][3])), 3);
+  EXPECT_EQ(bdd_satcount(formula), count);
+  // Other tests expect variable number to be its level
+  std::ranges::reverse(groups);
+  h.setGroupOrder(groups);
+  EXPECT_EQ(bdd_var2level(nTotalVars - 1), nTotalVars - 1);
+}
+
+TEST_F(VarsSetupFixture, BDDHelper_VarBlocks)
+{
+  using namespace bddHelper;
+  // Order is bad for this formula: first bit of each object color
+  // depends on the last bit of previous one
+  auto formula = bdd_true();
+  for (auto objNum : std::views::iota(1, nObjs))
+    formula &= bdd_biimp(v[objNum][0][0], v[objNum - 1][0][3]);
+  auto count = bdd_satcount(formula);
+  h.addVarBlocks();
+  bdd_reorder(BDD_REORDER_SIFT);
+  EXPECT_EQ(bdd_satcount(formula), count);
+  // Bits of each group are still together and in the same order
+  for (auto objNum : std::views::iota(0, nObjs))
+    for (auto propNum : std::views::iota(0, nProps))
+    {
+      auto first = bdd_var2level(bdd_var(v[objNum][propNum][0]));
+      for (auto bit : std::views::iota(1, nValueBits))
+        EXPECT_EQ(bdd_var2level(bdd_var(v[objNum][propNum][bit])), first + bit);
+    }
+  // Other tests expect variable number to be its level
+  bdd_clrvarblocks();
+  std::vector< int > order(nTotalVars);
+  std::iota(order.begin(), order.end(), 0);
+  bdd_setvarorder(order.data());
+  EXPECT_EQ(bdd_var2level(nTotalVars - 1), nTotalVars - 1);
+}
+
+TEST_F(VarsSetupFixture, BDDHelper_SiftGroups)
+{
+  using namespace bddHelper;
+  // Colors of FIRST and FOURTH objects are equal, and so are colors
+  // of SECOND and THIRD: groups of FOURTH and SECOND should be swapped
+  auto formula = bdd_true();
+  for (auto bit : std::views::iota(0, nValueBits))
+    formula &= bdd_biimp(v[0][0][bit], v[3][0][bit]) & bdd_biimp(v[1][0][bit], v[2][0][bit]);
+  auto count = bdd_satcount(formula);
+  auto nodes = bdd_nodecount(formula);
+  auto nReorders = BDDHelper::reorderStats().nReorders;
+  h.siftGroups({ formula });
+  EXPECT_EQ(BDDHelper::reorderStats().nReorders, nReorders + 1);
+  EXPECT_EQ(bdd_satcount(formula), count);
+  EXPECT_LT(bdd_nodecount(formula), nodes);
+  // Bits of each group are still together and in the same order
+  for (auto objNum : std::views::iota(0, nObjs))
+    for (auto propNum : std::views::iota(0, nProps))
+    {
+      auto first = bdd_var2level(bdd_var(v[objNum][propNum][0]));
+      for (auto bit : std::views::iota(1, nValueBits))
+        EXPECT_EQ(bdd_var2level(bdd_var(v[objNum][propNum][bit])), first + bit);
+    }
+  // Other tests expect variable number to be its level
+  std::vector< int > order(nTotalVars);
+  std::iota(order.begin(), order.end(), 0);
+  bdd_setvarorder(order.data());
+  EXPECT_EQ(bdd_var2level(nTotalVars - 1), nTotalVars - 1);
+}
+
+TEST_F(VarsSetupFixture, BDDHelper_Fdd)
+{
+  using namespace bddHelper;
+  // FDD domains add variables and other tests expect exactly nTotalVars of them,
+  // so it's checked in a child process
+  auto check = []() {
+    auto fdd = BDDHelper::withFdd(VarOrder::OBJECT_MAJOR);
+    bool ok = fdd.encoding() == Encoding::FDD;
+    for (auto objNum : std::views::iota(0, nObjs))
+      for (auto propNum : std::views::iota(0, nProps))
+      {
+        auto obj = static_cast< Object >(objNum);
+        auto prop = static_cast< Property >(propNum);
+        auto groupVars = fdd.getObjPropertyVars(obj, prop);
+        // Same code as binary encoding, so printing works as it is
+        for (auto valNum : std::views::iota(0, nVals))
+          ok = ok and fdd.getObjectVal(obj, prop, valNum) == fdd.numToBin(valNum, groupVars);
+        // One domain condition instead of 7 "not value" ones
+        auto bounds = fdd.getValueBounds(obj, prop);
+        auto binaryBound = bdd_true();
+        for (auto code : std::views::iota(nVals, 16))
+          binaryBound &= not fdd.numToBinUnsafe(code, groupVars);
+        ok = ok and bounds.size() == 1 and bounds[0] == binaryBound;
+      }
+    std::exit(ok ? 0 : 1);
+  };
+  EXPECT_EXIT(check(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(VarsSetupFixture, BDDHelper_ExactlyOne)
+{
+  using namespace bddHelper;
+  auto formula = BDDHelper::exactlyOne(v[0][0]);
+  EXPECT_EQ(bdd_satcount(formula), 4 * std::pow(2.0, nTotalVars - 4));
+  EXPECT_EQ(formula & v[0][0][1], v[0][0][1] & not v[0][0][0] & not v[0][0][2] & not v[0][0][3]);
+  EXPECT_EQ(BDDHelper::exactlyOne({}), bdd_false());
+}
+
 #endif
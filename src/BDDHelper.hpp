@@ -6,7 +6,9 @@
 #include <cassert>
 #include <utility>
 #include <cmath>
+#include <string>
 #include "bdd.h"
+#include "fdd.h"
 
 /**
  * Wherever in prog you see GTEST_TESTING or gtest or anything
@@ -106,6 +108,28 @@ namespace bddHelper
     ELEPHANT
   };
 
+  /**
+   * How objects properties bits are placed among bdd variables.
+   * Until variables are reordered, variable number is also its level,
+   * so this decides which bits are close to each other in formulas.
+   */
+  enum class VarOrder
+  {
+    OBJECT_MAJOR,   // All properties of first object, then of second...
+    PROPERTY_MAJOR, // Colors of all objects, then nations of all objects...
+    BIT_SLICED      // First bits of all objects colors, then second bits...
+  };
+
+  /**
+   * How object property value is coded with variables.
+   */
+  enum class Encoding
+  {
+    BINARY,  // Our own 4 bits binary number, see numToBin
+    FDD,     // BuDDy finite domain of 9 values, see fdd.h. Also 4 bits
+    ONE_HOT  // 9 variables, one per value. Exactly one of them is true
+  };
+
   /**
    * Funciton used to transform all but Property enums values
    * into int with size checking. Of course we can do static_cast
@@ -198,22 +222,102 @@ namespace bddHelper
     static constexpr int nValuesVars = nObjs * nProps * nValueBits;
     static constexpr int nTotalVars = nValuesVars;
 
+    // What happened in dynamic reorderings. See enableReorder.
+    struct ReorderStats
+    {
+      int nReorders = 0;   // How many times variables were reordered
+      double seconds = 0;  // Total time of reorderings
+      long nodesBefore = 0; // Sum of live nodes before each reordering
+      long nodesAfter = 0;  // Sum of live nodes after each reordering
+    };
+
+    // Bits of one object property. They always stay together in variables order.
+    using Group = std::pair< Object, Property >;
+
     // See BDDHelper.cpp file
-    BDDHelper(vect< vect< vect< bdd > > > structedVars);
+    BDDHelper(vect< vect< vect< bdd > > > structedVars, Encoding encoding = Encoding::BINARY);
+
+    // See BDDHelper.cpp file
+    static int varIndex(VarOrder order, int objNum, int propNum, int bit, int nGroupVars = nValueBits);
+
+    // See BDDHelper.cpp file
+    static BDDHelper withBinary(VarOrder order);
+
+    // See BDDHelper.cpp file
+    static BDDHelper withFdd(VarOrder order);
+
+    // See BDDHelper.cpp file
+    static BDDHelper withOneHot(VarOrder order);
+
+    Encoding encoding() const;
+
+    // Variables of one object property: nValueBits, or nVals with ONE_HOT
+    int nGroupVars() const;
+
+    // Variables of all object properties
+    int nVars() const;
 
     // See below
     template< class V_t >
     bdd getObjectVal(Object obj, V_t value);
 
+    /**
+     * Same as getObjectVal above, but value is given by number.
+     * Useful when we loop over all the values of property.
+     */
+    bdd getObjectVal(Object obj, Property prop, int valNum);
+
     // See BDDHelper.cpp file
     std::vector< bdd > getObjPropertyVars(Object obj, Property prop);
 
+    // See BDDHelper.cpp file
+    bdd getPropertyVarSet(Property prop);
+
+    // See BDDHelper.cpp file
+    std::vector< bdd > getValueBounds(Object obj, Property prop);
+
+    // See BDDHelper.cpp file
+    int getVarNum(Object obj, Property prop, int bit) const;
+
+    // See BDDHelper.cpp file
+    int getValNum(Object obj, Property prop, const std::string &varset) const;
+
+    // See BDDHelper.cpp file
+    void setGroupOrder(const std::vector< Group > &groups);
+
+    // See BDDHelper.cpp file
+    std::vector< Group > getGroupOrder() const;
+
+    // See BDDHelper.cpp file
+    void addVarBlocks();
+
+    // See BDDHelper.cpp file
+    static void enableReorder(int method, int maxTimes);
+
+    // See BDDHelper.cpp file
+    static void disableReorder();
+
+    // Statistics of reorderings since enableReorder
+    static const ReorderStats &reorderStats();
+
+    // See BDDHelper.cpp file
+    void siftGroups(const std::vector< bdd > &formulas);
+
     // See BDDHelper.cpp file
     bdd numToBin(int num, vect< bdd > vars);
 
     // See BDDHelper.cpp file
     bdd numToBinUnsafe(int num, vect< bdd > vars);
 
+    // See BDDHelper.cpp file
+    bdd notNumToBin(int num, const vect< bdd > &vars);
+
+    // See BDDHelper.cpp file
+    vect< bdd > oneHotValues(const vect< bdd > &vars);
+
+    // See BDDHelper.cpp file
+    static bdd exactlyOne(const vect< bdd > &vars);
+
   private:
   #ifdef GTEST_TESTING // ignore
     friend class ::VarsSetupFixture_BDDHelperbasic_Test;
@@ -223,6 +327,9 @@ namespace bddHelper
     // See constructor
     vect< vect< vect< bdd > > > structVars_;
     vect< vect< vect< bdd > > > values_;
+    Encoding encoding_ = Encoding::BINARY;
+    // FDD domain of each object property. Empty with binary encoding.
+    vect< vect< int > > domains_;
   };
 
   /**
@@ -0,0 +1,188 @@
+#include "BDDManager.hpp"
+#include "kernel.h"
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#ifdef __linux__
+#include <sys/mman.h>
+// Linux 6.1, older glibc headers don't have it
+#ifndef MADV_COLLAPSE
+#define MADV_COLLAPSE 25
+#endif
+#endif
+
+namespace
+{
+  // Held by the manager that owns BuDDy
+  std::mutex buddyMutex;
+  constexpr unsigned long hugePageSize = 2ul << 20;
+
+  /**
+   * Transparent huge pages mode, the one in brackets in sysfs file,
+   * is always or madvise. With never madvise still succeeds,
+   * but nothing gets huge pages.
+   */
+  bool hugePagesEnabled()
+  {
+    std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string modes;
+    std::getline(file, modes);
+    return modes.find("[always]") != std::string::npos or modes.find("[madvise]") != std::string::npos;
+  }
+
+  /**
+   * Ask kernel to back BuDDy nodes table with 2 MB pages.
+   * Only whole huge pages inside the table are advised,
+   * so memory around it is not touched.
+   */
+  BDDManager::HugePages adviseNodeTable()
+  {
+    BDDManager::HugePages res;
+#ifdef __linux__
+    auto start = reinterpret_cast< unsigned long >(bddnodes);
+    auto end = start + static_cast< unsigned long >(bddnodesize) * sizeof(BddNode);
+    auto first = (start + hugePageSize - 1) / hugePageSize * hugePageSize;
+    auto last = end / hugePageSize * hugePageSize;
+    if (first >= last)
+      return res;
+    auto address = reinterpret_cast< void * >(first);
+    if (madvise(address, last - first, MADV_HUGEPAGE) != 0)
+      return res;
+    res.advised = last - first;
+    // BuDDy has already filled the table, so its pages exist. Collapse
+    // them to huge ones now. If kernel can't (older than 6.1, no free
+    // huge pages), khugepaged does it later in background.
+    if (madvise(address, last - first, MADV_COLLAPSE) == 0)
+      res.collapsed = res.advised;
+#endif
+    return res;
+  }
+
+  // BuDDy moved nodes table to new memory
+  void resizeHook(int, int)
+  {
+    adviseNodeTable();
+  }
+}
+
+/**
+ * Wait until BuDDy is free and initialize it with nodes table
+ * of nodes size and caches of cacheSize (see bdd_init).
+ * With quietGbc garbage collections are not printed.
+ * Throws std::runtime_error if bdd_init fails: no memory, or BuDDy
+ * was initialized not by a manager. BuDDy's default error handler
+ * exits before that, so it's seen only with bdd_error_hook set.
+ */
+BDDManager::BDDManager(int nodes, int cacheSize, bool quietGbc) :
+  lock_(buddyMutex)
+{
+  if (auto error = bdd_init(nodes, cacheSize); error != 0)
+    throw std::runtime_error(std::string("BuDDy is not initialized: ") + bdd_errstring(error));
+  if (quietGbc)
+    bdd_gbc_hook(nullptr);
+}
+
+// Free everything BuDDy has, next manager may start
+BDDManager::~BDDManager()
+{
+  bdd_resize_hook(nullptr);
+  bdd_done();
+}
+
+/**
+ * Put BuDDy nodes table on huge pages (2 MB instead of 4 KB),
+ * so walking millions of nodes needs less TLB entries.
+ * BuDDy allocates it with plain malloc, so we madvise the memory
+ * at bddnodes. When BuDDy grows the table, the new one is advised
+ * in resize hook. Caches are static inside BuDDy library, their
+ * addresses can't be reached from here, so they stay on normal pages.
+ * Result is false (nothing advised) if it's not possible: not Linux,
+ * transparent huge pages are disabled or table is less than 2 huge
+ * pages. Then everything works as before on normal pages.
+ */
+BDDManager::HugePages BDDManager::useHugePages()
+{
+  if (not hugePagesEnabled())
+    return {};
+  auto res = adviseNodeTable();
+  if (res)
+    bdd_resize_hook(resizeHook);
+  return res;
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include <thread>
+#include <algorithm>
+#include <vector>
+#include <ranges>
+#include <cstdlib>
+#include "BDDHelper.hpp"
+#include "BDDFormulaBuilder.hpp"
+#include "Conditions.hpp"
+
+TEST(BDDManager, solvesTakeTurns)
+{
+  using namespace bddHelper;
+  // Test main owns BuDDy without manager, so it's done in a child process.
+  // _Exit, because static bdd of other tests can't be destroyed after bdd_done.
+  // Threads start together, but managers make their solves run one by one.
+  auto check = []() {
+    bdd_done();
+    constexpr int nSolves = 4;
+    std::vector< double > counts(nSolves);
+    {
+      std::vector< std::jthread > threads;
+      for (auto solve : std::views::iota(0, nSolves))
+      {
+        threads.emplace_back([&counts, solve]() {
+          BDDManager manager(100000, 10000, true);
+          auto h = BDDHelper::withBinary(solve % 2 ? VarOrder::PROPERTY_MAJOR : VarOrder::OBJECT_MAJOR);
+          BDDFormulaBuilder builder;
+          conditions::addConditions(h, builder);
+          counts[solve] = bdd_satcount(builder.result());
+        });
+      }
+    }
+    std::_Exit(std::ranges::count(counts, 6.0) == nSolves ? 0 : 1);
+  };
+  EXPECT_EXIT(check(), testing::ExitedWithCode(0), "");
+}
+
+TEST(BDDManager, initError)
+{
+  // Test main already owns BuDDy, so bdd_init fails.
+  // Default handler would exit, this one lets bdd_init return the error.
+  auto defaultHandler = bdd_error_hook([](int) {});
+  EXPECT_THROW(BDDManager(1000, 100, true), std::runtime_error);
+  bdd_error_hook(defaultHandler);
+}
+
+TEST(BDDManager, hugePages)
+{
+  using namespace bddHelper;
+  // Huge pages may be not available here, but solving must work anyway
+  auto check = []() {
+    bdd_done();
+    double count = 0;
+    {
+      // 20 MB table, so it has whole huge pages inside
+      BDDManager manager(1000000, 10000, true);
+      auto pages = manager.useHugePages();
+#ifdef __linux__
+      if (static_cast< bool >(pages) != hugePagesEnabled())
+        std::_Exit(2);
+#endif
+      if (pages.advised > static_cast< unsigned long >(bddnodesize) * sizeof(BddNode) or pages.collapsed > pages.advised)
+        std::_Exit(3);
+      auto h = BDDHelper::withBinary(VarOrder::OBJECT_MAJOR);
+      BDDFormulaBuilder builder;
+      conditions::addConditions(h, builder);
+      count = bdd_satcount(builder.result());
+    }
+    std::_Exit(count == 6 ? 0 : 1);
+  };
+  EXPECT_EXIT(check(), testing::ExitedWithCode(0), "");
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef BDD_MANAGER_HPP
+#define BDD_MANAGER_HPP
+
+#include "bdd.h"
+#include <mutex>
+
+/**
+ * Owner of BuDDy: nodes table, caches and variables.
+ * It does NOT let solves run at the same time. BuDDy keeps all its
+ * state in global variables of the prebuilt library (see kernel.h),
+ * so there is one BuDDy per process, and two solves in one process
+ * can't run concurrently whatever we do here. Run them in separate
+ * processes for that.
+ * Manager only makes sharing BuDDy safe: one manager owns it at a time,
+ * manager created while other one lives waits until that one is
+ * destroyed. So threads may solve independent puzzles one after another:
+ * ```
+ * std::jthread([]() {
+ *   BDDManager manager(100000, 10000);
+ *   auto h = BDDHelper::withBinary(VarOrder::OBJECT_MAJOR);
+ *   ...
+ * });
+ * ```
+ * Every bdd of a solve must be destroyed before its manager,
+ * so create manager first.
+ */
+class BDDManager
+{
+public:
+  // See BDDManager.cpp file
+  BDDManager(int nodes, int cacheSize, bool quietGbc = false);
+  // See BDDManager.cpp file
+  ~BDDManager();
+
+  // Bytes of nodes table useHugePages put on huge pages
+  struct HugePages
+  {
+    unsigned long advised = 0;   // Advised with MADV_HUGEPAGE
+    unsigned long collapsed = 0; // Of them already made huge, others will be later
+    explicit operator bool() const { return advised > 0; }
+  };
+
+  // See BDDManager.cpp file
+  HugePages useHugePages();
+
+  BDDManager(const BDDManager &) = delete;
+  BDDManager &operator=(const BDDManager &) = delete;
+
+private:
+  std::unique_lock< std::mutex > lock_;
+};
+
+#endif
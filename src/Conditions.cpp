@@ -1,14 +1,16 @@
 #include "Conditions.hpp"
+#include "NaryApply.hpp"
 #include <ranges>
 #include <tuple>
 #include <optional>
 #include <algorithm>
 #include <numeric>
-#include <execution>
 #include <functional>
 #include <type_traits>
+#include <bit>
 
 using namespace bddHelper;
+using dualModel::DualModel;
 
 namespace // Dont read this...
 {
@@ -28,6 +30,10 @@ namespace // Dont read this...
   template < class T1 >
   struct unique_types< T1 >
   { };
+
+  // Compiles only if all the types are different
+  template < class ... Ts >
+  constexpr bool check_uniquness = sizeof(unique_types< Ts ... >) > 0;
 }
 
 namespace std
@@ -96,6 +102,21 @@ namespace
   template < class V_t1, class V_t2 >
   void addRightNeighbour(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder);
 
+  // See below. Same conditions said with positions of values.
+  template < class ... V_ts >
+  void addLoopCondition(std::tuple< V_ts... > values, DualModel &d, BDDFormulaBuilder &builder);
+  // See below
+  template < class V_t1, class V_t2 >
+  void addNeighbours(V_t1 value1, V_t2 value2, DualModel &d, BDDFormulaBuilder &builder);
+  // See below
+  template < class V_t1, class V_t2 >
+  void addLeftNeighbour(V_t1 value1, V_t2 value2, DualModel &d, BDDFormulaBuilder &builder);
+  // See below
+  template < class V_t1, class V_t2 >
+  void addRightNeighbour(V_t1 value1, V_t2 value2, DualModel &d, BDDFormulaBuilder &builder);
+  // See below
+  bdd arePositionsNeighbours(const bvec &pos, const bvec &neighbPos, std::vector< int > neighbourXYOffset);
+
   // See below
   std::optional< Object > getNeighbour_(Object obj, std::vector< int > neighbourXYOffset);
   // See below
@@ -105,23 +126,28 @@ namespace
   // See below
   std::vector< Object > getNeighbours(Object obj);
 
-  // See below
-  bdd equal(bdd a, bdd b);
   // See below
   bdd notEqual(std::vector< bdd > v1, std::vector< bdd > v2);
 
   // See below
-  void addFirstCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class Model >
+  void addFirstCondition(Model &m, BDDFormulaBuilder &builder);
   // See below
-  void addSecondCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class Model >
+  void addSecondCondition(Model &m, BDDFormulaBuilder &builder);
   // See below
   void addThirdCondition(BDDHelper &h, BDDFormulaBuilder &builder);
   // See below
-  void addFourthCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  template < class Model >
+  void addFourthCondition(Model &m, BDDFormulaBuilder &builder);
   // See below
-  void addUniqueCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  void addUniqueCondition(BDDHelper &h, BDDFormulaBuilder &builder, conditions::Uniqueness uniqueness);
   // See below
   void addValuesUpperBoundCondition(BDDHelper &h, BDDFormulaBuilder &builder);
+  // See below
+  void addUniqueCondition(DualModel &d, BDDFormulaBuilder &builder);
+  // See below
+  void addValuesUpperBoundCondition(DualModel &d, BDDFormulaBuilder &builder);
 
   /**
    * Sets second type condition.
@@ -148,25 +174,24 @@ namespace
   void addLoopCondition(std::tuple< V_ts... > values, BDDHelper &h, BDDFormulaBuilder &builder)
   {
     // Helps to avoid controversy in conditions.
-    unique_types< V_ts... > check_uniquness;
-    auto resultFormulaToAdd = bdd_false();
+    static_assert(check_uniquness< V_ts... >);
+    // Objects that may have all the values, joined with OR at once (see NaryApply.hpp)
+    std::vector< bdd > objectsFormulas;
     // Here we loop through objects and say that
     // current object must have all given values.
     for (auto i : std::views::iota(0, BDDHelper::nObjs))
     {
       auto obj = static_cast< Object >(i);
-      auto formulas = bdd_true();
-      std::apply([&formulas, &h, &obj](auto &&... args) {
-        ((formulas &= h.getObjectVal(obj, args)), ...); //Here we say current object must have all given values.
+      std::apply([&objectsFormulas, &h, &obj](auto &&... args) {
+        objectsFormulas.push_back(naryApply::conjunction({ h.getObjectVal(obj, args)... })); //Here we say current object must have all given values.
       }, values);
-      // Here we say that there must be
-      // first object with all values or
-      // second object with all values or
-      // third object with all values or...
-      resultFormulaToAdd |= formulas;
     }
+    // Here we say that there must be
+    // first object with all values or
+    // second object with all values or
+    // third object with all values or...
     // Add result condition
-    builder.addCondition(resultFormulaToAdd);
+    builder.addCondition(naryApply::disjunction(std::move(objectsFormulas)));
   }
 
   // This function says that there must be any neighbours
@@ -179,7 +204,8 @@ namespace
   void addNeighbours(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder)
   {
     static_assert(traits_::IsValueType_v< V_t1 > && traits_::IsValueType_v< V_t2 >, "Value must be one of properties type");
-    auto resultFormulaToAdd = bdd_false();
+    // Pairs of neighbours, joined with OR at once (see NaryApply.hpp)
+    std::vector< bdd > pairsFormulas;
     // So we loop though the objects and say that
     // for ANY object...
     for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
@@ -188,10 +214,10 @@ namespace
       // ...current object must have value1 and
       // current object's any neighbour must have value2
       for (auto neighbObj : getNeighbours(obj)) // According to skleika we may have or not neighbours of current object
-        resultFormulaToAdd |= (h.getObjectVal(obj, value1) & h.getObjectVal(neighbObj, value2));
+        pairsFormulas.push_back(h.getObjectVal(obj, value1) & h.getObjectVal(neighbObj, value2));
     }
     // Add result condition to formula
-    builder.addCondition(resultFormulaToAdd);
+    builder.addCondition(naryApply::disjunction(std::move(pairsFormulas)));
   }
 
   // This function says that there must be any LEFT neighbours
@@ -204,7 +230,7 @@ namespace
   void addLeftNeighbour(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder)
   {
     static_assert(traits_::IsValueType_v< V_t1 > && traits_::IsValueType_v< V_t2 >, "Value must be one of properties type");
-    auto resultFormulaToAdd = bdd_false();
+    std::vector< bdd > pairsFormulas;
     // So we loop though the objects and say that
     // for ANY object...
     for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
@@ -213,9 +239,9 @@ namespace
       // ...current object must have value1 and
       // current object's LEFT neighbour must have value2
       if (auto neighbObj = getLeftNeighbour(obj); neighbObj.has_value())
-        resultFormulaToAdd |= (h.getObjectVal(obj, value1) & h.getObjectVal(*neighbObj, value2));
+        pairsFormulas.push_back(h.getObjectVal(obj, value1) & h.getObjectVal(*neighbObj, value2));
     }
-    builder.addCondition(resultFormulaToAdd);
+    builder.addCondition(naryApply::disjunction(std::move(pairsFormulas)));
   }
 
   // Read about left neighbour if need
@@ -223,16 +249,84 @@ namespace
   void addRightNeighbour(V_t1 value1, V_t2 value2, BDDHelper &h, BDDFormulaBuilder &builder)
   {
     static_assert(traits_::IsValueType_v< V_t1 > && traits_::IsValueType_v< V_t2 >, "Value must be one of properties type");
-    auto resultFormulaToAdd = bdd_false();
+    std::vector< bdd > pairsFormulas;
     for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
     {
       auto obj = static_cast< Object >(objNum);
       if (auto neighbObj = getRightNeighbour(obj); neighbObj.has_value())
-        resultFormulaToAdd |= (h.getObjectVal(obj, value1) & h.getObjectVal(*neighbObj, value2));
+        pairsFormulas.push_back(h.getObjectVal(obj, value1) & h.getObjectVal(*neighbObj, value2));
     }
+    builder.addCondition(naryApply::disjunction(std::move(pairsFormulas)));
+  }
+
+  // Dual form of addLoopCondition: all the values have the same position
+  template < class ... V_ts >
+  void addLoopCondition(std::tuple< V_ts... > values, DualModel &d, BDDFormulaBuilder &builder)
+  {
+    static_assert(check_uniquness< V_ts... >);
+    auto firstPos = d.getPosition(std::get< 0 >(values));
+    auto resultFormulaToAdd = bdd_true();
+    std::apply([&resultFormulaToAdd, &firstPos, &d](auto &&... args) {
+      ((resultFormulaToAdd &= firstPos == d.getPosition(args)), ...);
+    }, values);
     builder.addCondition(resultFormulaToAdd);
   }
 
+  // Dual form of addNeighbours: relation of two positions, 8 variables only
+  template < class V_t1, class V_t2 >
+  void addNeighbours(V_t1 value1, V_t2 value2, DualModel &d, BDDFormulaBuilder &builder)
+  {
+    auto pos1 = d.getPosition(value1);
+    auto pos2 = d.getPosition(value2);
+    builder.addCondition(arePositionsNeighbours(pos1, pos2, leftNeighbourXYOffset) |
+                         arePositionsNeighbours(pos1, pos2, rightNeighbourXYOffset));
+  }
+
+  // Dual form of addLeftNeighbour
+  template < class V_t1, class V_t2 >
+  void addLeftNeighbour(V_t1 value1, V_t2 value2, DualModel &d, BDDFormulaBuilder &builder)
+  {
+    builder.addCondition(arePositionsNeighbours(d.getPosition(value1), d.getPosition(value2), leftNeighbourXYOffset));
+  }
+
+  // Dual form of addRightNeighbour
+  template < class V_t1, class V_t2 >
+  void addRightNeighbour(V_t1 value1, V_t2 value2, DualModel &d, BDDFormulaBuilder &builder)
+  {
+    builder.addCondition(arePositionsNeighbours(d.getPosition(value1), d.getPosition(value2), rightNeighbourXYOffset));
+  }
+
+  /**
+   * Dual form of getNeighbour_: object at neighbPos is neighbour of
+   * object at pos. Same skleika rules, but said with arithmetic:
+   *    x = pos % 3, y = pos / 3
+   *    with skleika:    (x + offset) % 3 == neighbX
+   *    without skleika:  x + offset      == neighbX
+   * Everything is shifted by 3, so numbers are never negative.
+   * bvec_divfixed of our BuDDy reports errors, so bvec_div is used.
+   */
+  bdd arePositionsNeighbours(const bvec &pos, const bvec &neighbPos, std::vector< int > neighbourXYOffset)
+  {
+    assert(neighbourXYOffset.size() == 2);
+    constexpr int nBits = BDDHelper::nValueBits;
+    auto three = bvec(nBits, 3);
+    bvec x, y, neighbX, neighbY;
+    bvec_div(pos, three, y, x);
+    bvec_div(neighbPos, three, neighbY, neighbX);
+    auto coordMatches = [&three](const bvec &coord, const bvec &neighbCoord, int offset, bool skleika) {
+      auto shifted = coord + bvec(nBits, offset + 3);
+      if (not skleika)
+        return shifted == neighbCoord + three;
+      bvec quotient, remainder;
+      bvec_div(shifted, three, quotient, remainder);
+      return remainder == neighbCoord;
+    };
+    auto nObjs = bvec(nBits, BDDHelper::nObjs);
+    return (pos < nObjs) & (neighbPos < nObjs) &
+           coordMatches(x, neighbX, neighbourXYOffset[0], horSkleika) &
+           coordMatches(y, neighbY, neighbourXYOffset[1], vertSkleika);
+  }
+
   std::optional< Object > getLeftNeighbour(Object obj)
   {
     return getNeighbour_(obj, leftNeighbourXYOffset);
@@ -354,19 +448,14 @@ namespace
     return resArr;
   }
 
-  // Speaks for itself
-  bdd equal(bdd a, bdd b)
-  {
-    return (a & b) | ((not a) & (not b));
-  }
-
   // a and b each contain 4 bdd variables
   // We say return condition
   // a[0] != b[0] or a[1] != b[1] or ... a[3] != b[3]
   // It's like comparing two binary numbers. Actually that is it.
+  // Works for one-hot variables too, they are just longer numbers.
   bdd notEqual(std::vector< bdd > a, std::vector< bdd > b)
   {
-    assert(a.size() == 4 && a.size() == b.size());
+    assert(not a.empty() && a.size() == b.size());
     return std::inner_product(
       a.begin(),
       a.end(),
@@ -374,40 +463,63 @@ namespace
       bdd_false(),
       std::bit_or< bdd >(),
       [](bdd a, bdd b) {
-      return not equal(a, b);
+      // Same as not bdd_biimp(a, b), but without negating its result
+      return a ^ b;
     });
   }
 
   // Here we say, that each property value must be used exactly one time
   // For example
   // Object::FIRST have Color::RED. That means SECOND, THIRD... can not have Color::RED
-  void addUniqueCondition(BDDHelper &h, BDDFormulaBuilder &builder)
+  void addUniqueCondition(BDDHelper &h, BDDFormulaBuilder &builder, conditions::Uniqueness uniqueness)
   {
-    auto propRange = std::views::iota(0, BDDHelper::nProps);
-    //We loop over properties
-    std::for_each(std::execution::par, propRange.begin(), propRange.end(),
-      [&](auto propNum) {
+    // Whole property at once, see conditions::allDifferent
+    if (uniqueness == conditions::Uniqueness::ALL_DIFFERENT)
+    {
+      for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+        builder.addCondition(conditions::allDifferent(h, static_cast< Property >(propNum)));
+      return;
+    }
+    // With one-hot encoding each value has variable, so we just say that
+    // exactly one object has it. 36 conditions instead of 144 pairs.
+    if (h.encoding() == Encoding::ONE_HOT)
+    {
+      for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+        for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+        {
+          std::vector< bdd > column;
+          for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+            column.push_back(h.getObjPropertyVars(static_cast< Object >(objNum), static_cast< Property >(propNum))[valNum]);
+          builder.addCondition(BDDHelper::exactlyOne(column));
+        }
+      return;
+    }
+    // Conditions are made in one thread: BuDDy is not thread safe,
+    // each bdd operation creates nodes and even copying bdd changes
+    // reference counters. Listing pairs is nothing compared to notEqual.
+    // We loop over properties
+    for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+    {
       auto prop = static_cast< Property >(propNum);
-      auto obj1Range = std::views::iota(0, BDDHelper::nObjs);
       // Loop over objects
-      std::for_each(std::execution::par, obj1Range.begin(), obj1Range.end(),
-        [&](auto objNum1) {
+      for (auto objNum1 : std::views::iota(0, BDDHelper::nObjs))
+      {
         auto obj1 = static_cast< Object >(objNum1);
-        auto obj2Range = std::views::iota(objNum1 + 1, BDDHelper::nObjs);
         // Loop over objects start with obj1+1
-        std::for_each(std::execution::par, obj2Range.begin(), obj2Range.end(),
-          [&](auto objNum2) {
+        for (auto objNum2 : std::views::iota(objNum1 + 1, BDDHelper::nObjs))
+        {
           auto obj2 = static_cast< Object >(objNum2);
           // We say that for current property
           // obj1 property value must be not equal to obj2 property value
-          builder.addConditionTh(notEqual(h.getObjPropertyVars(obj1, prop), h.getObjPropertyVars(obj2, prop)));
-        });
-      });
-    });
+          builder.addCondition(notEqual(h.getObjPropertyVars(obj1, prop), h.getObjPropertyVars(obj2, prop)));
+        }
+      }
+    }
   }
 
   // Here we simply state that each object's properties values must be less than 9
   // In other words, each object's properties values must be NOT 9 NOT 10 NOT 11... NOT 15
+  // How exactly it's said depends on encoding, see BDDHelper::getValueBounds
   void addValuesUpperBoundCondition(BDDHelper &h, BDDFormulaBuilder &builder)
   {
     // Loop over objects
@@ -418,27 +530,44 @@ namespace
       for (auto propNum : std::views::iota(0, BDDHelper::nProps))
       {
         auto prop = static_cast< Property >(propNum);
-        // Loop over possible property value numbers
-        for (auto valNum : std::views::iota(9, 16))
-        {
-          // Say that for object obj property prop can not have value equal to valNum
-          builder.addCondition(not h.numToBinUnsafe(valNum, h.getObjPropertyVars(obj, prop)));
-        }
+        for (auto &bound : h.getValueBounds(obj, prop))
+          builder.addCondition(bound);
       }
     }
   }
 
+  // Dual form of addUniqueCondition: values of property have different positions
+  void addUniqueCondition(DualModel &d, BDDFormulaBuilder &builder)
+  {
+    for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+    {
+      auto prop = static_cast< Property >(propNum);
+      for (auto valNum1 : std::views::iota(0, BDDHelper::nVals))
+        for (auto valNum2 : std::views::iota(valNum1 + 1, BDDHelper::nVals))
+          builder.addCondition(not (d.getPosition(prop, valNum1) == d.getPosition(prop, valNum2)));
+    }
+  }
+
+  // Dual form of addValuesUpperBoundCondition: positions are less than 9
+  void addValuesUpperBoundCondition(DualModel &d, BDDFormulaBuilder &builder)
+  {
+    for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+      for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+        builder.addCondition(d.getPositionBound(static_cast< Property >(propNum), valNum));
+  }
+
   /**
    * Here we add conditions of type 1
    * For example
    * builder.addCondition(h.getObjectVal(Object::FIRST, Nation::UKRAINE));
    * This means that First object MUST have Property Nation with value Nation::UKRAINE
    */
-  void addFirstCondition(BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class Model >
+  void addFirstCondition(Model &m, BDDFormulaBuilder &builder)
   {
-    builder.addCondition(h.getObjectVal(Object::SECOND, Nation::HISPANE));
-    builder.addCondition(h.getObjectVal(Object::FIFTH, Nation::CHINA));
-    builder.addCondition(h.getObjectVal(Object::EIGTH, Nation::RUSSIAN));
+    builder.addCondition(m.getObjectVal(Object::SECOND, Nation::HISPANE));
+    builder.addCondition(m.getObjectVal(Object::FIFTH, Nation::CHINA));
+    builder.addCondition(m.getObjectVal(Object::EIGTH, Nation::RUSSIAN));
   }
 
   /**
@@ -449,37 +578,38 @@ namespace
    * There MUST exist object that has BOTH Nation::UKRAINE and Animal::DOG.
    * No matter if it Object::FIRST or Object::SECOND or...
    */
-  void addSecondCondition(BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class Model >
+  void addSecondCondition(Model &m, BDDFormulaBuilder &builder)
   {
-    addLoopCondition(std::make_tuple(Nation::UKRAINE, Animal::DOG), h, builder);
-    addLoopCondition(std::make_tuple(Nation::BELORUS, Animal::CAT), h, builder);
-    addLoopCondition(std::make_tuple(Nation::GRUZIN, Animal::REPTILIES), h, builder);
-    addLoopCondition(std::make_tuple(Nation::HISPANE, Animal::HOMYAK), h, builder);
-    addLoopCondition(std::make_tuple(Nation::CHINA, Animal::FISH), h, builder);
-    addLoopCondition(std::make_tuple(Nation::RUSSIAN, Animal::HORSE), h, builder);
-    addLoopCondition(std::make_tuple(Nation::CHE4ENCI, Animal::BIRD), h, builder);
-    addLoopCondition(std::make_tuple(Nation::ARMENIAN, Animal::LION), h, builder);
-    addLoopCondition(std::make_tuple(Nation::KAZAH, Animal::ELEPHANT), h, builder);
-
-    addLoopCondition(std::make_tuple(Nation::UKRAINE, Plant::MALINA), h, builder);
-    addLoopCondition(std::make_tuple(Nation::BELORUS, Plant::CHERRY), h, builder);
-    addLoopCondition(std::make_tuple(Nation::GRUZIN, Plant::KRIZH), h, builder);
-    addLoopCondition(std::make_tuple(Nation::HISPANE, Plant::KLUBN), h, builder);
-    addLoopCondition(std::make_tuple(Nation::CHINA, Plant::VINOGR), h, builder);
-    addLoopCondition(std::make_tuple(Nation::RUSSIAN, Plant::SLIVA), h, builder);
-    addLoopCondition(std::make_tuple(Nation::CHE4ENCI, Plant::GRUSHA), h, builder);
-    addLoopCondition(std::make_tuple(Nation::ARMENIAN, Plant::APPLE), h, builder);
-    addLoopCondition(std::make_tuple(Nation::KAZAH, Plant::PINEAPPLE), h, builder);
-
-    addLoopCondition(std::make_tuple(Nation::UKRAINE, Color::RED), h, builder);
-    addLoopCondition(std::make_tuple(Nation::BELORUS, Color::GREEN), h, builder);
-    addLoopCondition(std::make_tuple(Nation::GRUZIN, Color::BLUE), h, builder);
-    addLoopCondition(std::make_tuple(Nation::HISPANE, Color::YELLOW), h, builder);
-    addLoopCondition(std::make_tuple(Nation::CHINA, Color::WHITE), h, builder);
-    addLoopCondition(std::make_tuple(Nation::RUSSIAN, Color::PURPLE), h, builder);
-    addLoopCondition(std::make_tuple(Nation::CHE4ENCI, Color::BROWN), h, builder);
-    addLoopCondition(std::make_tuple(Nation::ARMENIAN, Color::AQUA), h, builder);
-    addLoopCondition(std::make_tuple(Nation::KAZAH, Color::BEIGE), h, builder);
+    addLoopCondition(std::make_tuple(Nation::UKRAINE, Animal::DOG), m, builder);
+    addLoopCondition(std::make_tuple(Nation::BELORUS, Animal::CAT), m, builder);
+    addLoopCondition(std::make_tuple(Nation::GRUZIN, Animal::REPTILIES), m, builder);
+    addLoopCondition(std::make_tuple(Nation::HISPANE, Animal::HOMYAK), m, builder);
+    addLoopCondition(std::make_tuple(Nation::CHINA, Animal::FISH), m, builder);
+    addLoopCondition(std::make_tuple(Nation::RUSSIAN, Animal::HORSE), m, builder);
+    addLoopCondition(std::make_tuple(Nation::CHE4ENCI, Animal::BIRD), m, builder);
+    addLoopCondition(std::make_tuple(Nation::ARMENIAN, Animal::LION), m, builder);
+    addLoopCondition(std::make_tuple(Nation::KAZAH, Animal::ELEPHANT), m, builder);
+
+    addLoopCondition(std::make_tuple(Nation::UKRAINE, Plant::MALINA), m, builder);
+    addLoopCondition(std::make_tuple(Nation::BELORUS, Plant::CHERRY), m, builder);
+    addLoopCondition(std::make_tuple(Nation::GRUZIN, Plant::KRIZH), m, builder);
+    addLoopCondition(std::make_tuple(Nation::HISPANE, Plant::KLUBN), m, builder);
+    addLoopCondition(std::make_tuple(Nation::CHINA, Plant::VINOGR), m, builder);
+    addLoopCondition(std::make_tuple(Nation::RUSSIAN, Plant::SLIVA), m, builder);
+    addLoopCondition(std::make_tuple(Nation::CHE4ENCI, Plant::GRUSHA), m, builder);
+    addLoopCondition(std::make_tuple(Nation::ARMENIAN, Plant::APPLE), m, builder);
+    addLoopCondition(std::make_tuple(Nation::KAZAH, Plant::PINEAPPLE), m, builder);
+
+    addLoopCondition(std::make_tuple(Nation::UKRAINE, Color::RED), m, builder);
+    addLoopCondition(std::make_tuple(Nation::BELORUS, Color::GREEN), m, builder);
+    addLoopCondition(std::make_tuple(Nation::GRUZIN, Color::BLUE), m, builder);
+    addLoopCondition(std::make_tuple(Nation::HISPANE, Color::YELLOW), m, builder);
+    addLoopCondition(std::make_tuple(Nation::CHINA, Color::WHITE), m, builder);
+    addLoopCondition(std::make_tuple(Nation::RUSSIAN, Color::PURPLE), m, builder);
+    addLoopCondition(std::make_tuple(Nation::CHE4ENCI, Color::BROWN), m, builder);
+    addLoopCondition(std::make_tuple(Nation::ARMENIAN, Color::AQUA), m, builder);
+    addLoopCondition(std::make_tuple(Nation::KAZAH, Color::BEIGE), m, builder);
   }
 
   /**
@@ -513,11 +643,12 @@ namespace
    *
    * Actually it uses addLeftNeighbour and addLeftNeighbour
    */
-  void addFourthCondition(BDDHelper &h, BDDFormulaBuilder &builder)
+  template < class Model >
+  void addFourthCondition(Model &m, BDDFormulaBuilder &builder)
   {
-    addNeighbours(Nation::UKRAINE, Nation::CHE4ENCI, h, builder);
-    addNeighbours(Nation::BELORUS, Nation::ARMENIAN, h, builder);
-    addNeighbours(Nation::GRUZIN, Nation::KAZAH, h, builder);
+    addNeighbours(Nation::UKRAINE, Nation::CHE4ENCI, m, builder);
+    addNeighbours(Nation::BELORUS, Nation::ARMENIAN, m, builder);
+    addNeighbours(Nation::GRUZIN, Nation::KAZAH, m, builder);
     // builder.addCondition(h.getObjectVal(Object::FIRST, Nation::UKRAINE));
     // builder.addCondition(h.getObjectVal(Object::SECOND, Nation::BELORUS));
     // builder.addCondition(h.getObjectVal(Object::THIRD, Nation::GRUZIN));
@@ -529,15 +660,69 @@ namespace
 
 namespace conditions
 {
-  void addConditions(BDDHelper &h, BDDFormulaBuilder &builder)
+  void addConditions(BDDHelper &h, BDDFormulaBuilder &builder, Uniqueness uniqueness, DualModel *dual)
   {
+    if (dual)
+    {
+      // Puzzle is solved with positions, then values are taken from them
+      addFirstCondition(*dual, builder);
+      addSecondCondition(*dual, builder);
+      addFourthCondition(*dual, builder);
+      addUniqueCondition(*dual, builder);
+      addValuesUpperBoundCondition(*dual, builder);
+      for (auto &condition : dual->getChanneling())
+        builder.addCondition(condition);
+      return;
+    }
     addFirstCondition(h, builder);
     addSecondCondition(h, builder);
     // addThirdCondition(h, builder);
     addFourthCondition(h, builder);
-    addUniqueCondition(h, builder);
+    addUniqueCondition(h, builder, uniqueness);
     addValuesUpperBoundCondition(h, builder);
   }
+
+  /**
+   * Objects have different values of property prop.
+   * Pairwise notEqual conditions are joined one by one and intermediate
+   * formulas remember a lot of half-checked pairs. Here formula is built
+   * directly, from the object on the last level up to the first one.
+   * rest[used] says that objects from current one to the last have
+   * different values not in used - values of objects above, 9 bits mask:
+   *    rest[used] = OR of (object has value v) AND rest'[used + v], v not in used
+   * where rest' is the same for the next object.
+   * Each step is AND of formula above with formula below, so it's cheap.
+   * Values are codes from getObjectVal, so bounds of prop are said too.
+   */
+  bdd allDifferent(BDDHelper &h, Property prop)
+  {
+    constexpr int nMasks = 1 << BDDHelper::nVals;
+    std::vector< Object > objs;
+    for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+      objs.push_back(static_cast< Object >(objNum));
+    std::ranges::sort(objs, {}, [&h, prop](Object obj) { return bdd_var2level(h.getVarNum(obj, prop, 0)); });
+
+    // All objects got their values
+    std::vector< bdd > rest(nMasks, bdd_false());
+    for (auto used : std::views::iota(0, nMasks))
+      if (std::popcount(static_cast< unsigned >(used)) == BDDHelper::nObjs)
+        rest[used] = bdd_true();
+    for (auto pos : std::views::iota(0, BDDHelper::nObjs) | std::views::reverse)
+    {
+      std::vector< bdd > current(nMasks, bdd_false());
+      for (auto used : std::views::iota(0, nMasks))
+      {
+        // Objects above pos use exactly pos values
+        if (std::popcount(static_cast< unsigned >(used)) != pos)
+          continue;
+        for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+          if (not (used & (1 << valNum)))
+            current[used] |= h.getObjectVal(objs[pos], prop, valNum) & rest[used | (1 << valNum)];
+      }
+      rest = std::move(current);
+    }
+    return rest[0];
+  }
 }
 
 #ifdef GTEST_TESTING
@@ -549,8 +734,15 @@ namespace conditions
 TEST_F(VarsSetupFixture, Conditions_Equality)
 {
   using namespace bddHelper;
-  EXPECT_EQ(equal(v[0][0][0], v[0][0][0]), bdd_true());
-  EXPECT_EQ(equal(v[0][0][0], not v[0][0][0]), bdd_false());
+  // notEqual is built with xor, it must be the same as not of bdd_biimp
+  EXPECT_EQ(notEqual({ v[0][0][0] }, { v[0][0][0] }), not bdd_biimp(v[0][0][0], v[0][0][0]));
+  EXPECT_EQ(notEqual({ v[0][0][0] }, { not v[0][0][0] }), not bdd_biimp(v[0][0][0], not v[0][0][0]));
+  EXPECT_EQ(notEqual({ v[0][0][0] }, { v[0][0][0] }), bdd_false());
+  EXPECT_EQ(notEqual({ v[0][0][0] }, { not v[0][0][0] }), bdd_true());
+  auto equalBits = bdd_true();
+  for (auto bit : std::views::iota(0, nValueBits))
+    equalBits &= bdd_biimp(v[0][0][bit], v[1][0][bit]);
+  EXPECT_EQ(notEqual(v[0][0], v[1][0]), not equalBits);
   EXPECT_EQ(notEqual(v[0][0], { v[0][0][0], not v[0][0][1], v[0][0][2], v[0][0][3] }), bdd_true());
 }
 
@@ -708,4 +900,108 @@ TEST_F(VarsSetupFixture, Conditions_LeftNeighborsCondition_skleika)
   EXPECT_EQ(build.result(), expectedResult);
 }
 
+TEST_F(VarsSetupFixture, Conditions_AllDifferent)
+{
+  using namespace bddHelper;
+  auto expected = bdd_true();
+  for (auto objNum1 : std::views::iota(0, nObjs))
+  {
+    auto obj1 = static_cast< Object >(objNum1);
+    for (auto bound : h.getValueBounds(obj1, Property::COLOR))
+      expected &= bound;
+    for (auto objNum2 : std::views::iota(objNum1 + 1, nObjs))
+      expected &= notEqual(h.getObjPropertyVars(obj1, Property::COLOR),
+                           h.getObjPropertyVars(static_cast< Object >(objNum2), Property::COLOR));
+  }
+  auto formula = conditions::allDifferent(h, Property::COLOR);
+  EXPECT_EQ(formula, expected);
+  // 9! ways to give colors, other variables are free
+  EXPECT_EQ(bdd_satcount(formula), 362880 * std::pow(2.0, nTotalVars - nObjs * nValueBits));
+}
+
+TEST_F(VarsSetupFixture, Conditions_PositionsNeighbours)
+{
+  using namespace bddHelper;
+  // Any 8 variables will do for two positions
+  auto toBvec = [](const std::vector< bdd > &vars) {
+    std::vector< int > varNums;
+    for (auto &var : vars | std::views::reverse)
+      varNums.push_back(bdd_var(var));
+    return bvec_varvec(nValueBits, varNums.data());
+  };
+  auto pos = toBvec(v[0][0]);
+  auto neighbPos = toBvec(v[1][0]);
+  auto left = arePositionsNeighbours(pos, neighbPos, leftNeighbourXYOffset);
+  auto right = arePositionsNeighbours(pos, neighbPos, rightNeighbourXYOffset);
+  // Same neighbours as getNeighbour_ finds
+  for (auto objNum : std::views::iota(0, nObjs))
+    for (auto neighbNum : std::views::iota(0, nObjs))
+    {
+      auto obj = static_cast< Object >(objNum);
+      auto neighb = static_cast< Object >(neighbNum);
+      auto at = (pos == bvec(nValueBits, objNum)) & (neighbPos == bvec(nValueBits, neighbNum));
+      EXPECT_EQ((left & at) != bdd_false(), getLeftNeighbour(obj) == neighb);
+      EXPECT_EQ((right & at) != bdd_false(), getRightNeighbour(obj) == neighb);
+    }
+}
+
+TEST_F(VarsSetupFixture, Conditions_DualModel)
+{
+  using namespace bddHelper;
+  BDDFormulaBuilder primary;
+  conditions::addConditions(h, primary);
+  auto expected = primary.result();
+  auto expectedCount = bdd_satcount(expected);
+  // Position variables are added after fixture ones and other tests
+  // expect exactly nTotalVars of them, so it's checked in a child process
+  auto check = [&]() {
+    dualModel::DualModel dual(h);
+    BDDFormulaBuilder builder;
+    conditions::addConditions(h, builder, conditions::Uniqueness::PAIRWISE, &dual);
+    auto formula = builder.result();
+    auto [model, varSet] = dual.smallerModel(formula);
+    bool ok = bdd_exist(formula, dual.getDualVarSet()) == expected and
+              bdd_satcountset(model, varSet) == expectedCount;
+    std::exit(ok ? 0 : 1);
+  };
+  EXPECT_EXIT(check(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(VarsSetupFixture, Conditions_OneHot)
+{
+  using namespace bddHelper;
+  BDDFormulaBuilder binary;
+  conditions::addConditions(h, binary);
+  auto expectedCount = bdd_satcount(binary.result());
+  // One-hot variables are added after fixture ones and other tests
+  // expect exactly nTotalVars of them, so it's checked in a child process
+  auto check = [expectedCount]() {
+    auto oneHot = BDDHelper::withOneHot(VarOrder::OBJECT_MAJOR);
+    BDDFormulaBuilder builder;
+    conditions::addConditions(oneHot, builder);
+    std::vector< int > varNums;
+    for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+      for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+        for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+          varNums.push_back(oneHot.getVarNum(static_cast< Object >(objNum), static_cast< Property >(propNum), valNum));
+    auto count = bdd_satcountset(builder.result(), bdd_makeset(varNums.data(), static_cast< int >(varNums.size())));
+    std::exit(count == expectedCount ? 0 : 1);
+  };
+  EXPECT_EXIT(check(), testing::ExitedWithCode(0), "");
+}
+
+TEST_F(VarsSetupFixture, Conditions_UniquePairs)
+{
+  using namespace bddHelper;
+  BDDFormulaBuilder builder;
+  addUniqueCondition(h, builder, conditions::Uniqueness::PAIRWISE);
+  // Same conditions in the same order as nested loops give
+  std::vector< bdd > expected;
+  for (auto propNum : std::views::iota(0, nProps))
+    for (auto objNum1 : std::views::iota(0, nObjs))
+      for (auto objNum2 : std::views::iota(objNum1 + 1, nObjs))
+        expected.push_back(notEqual(v[objNum1][propNum], v[objNum2][propNum]));
+  EXPECT_EQ(builder.pending(), expected);
+}
+
 #endif
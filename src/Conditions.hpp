@@ -1,11 +1,35 @@
+#ifndef CONDITIONS_HPP
+#define CONDITIONS_HPP
+
 #include "bdd.h"
 #include "BDDHelper.hpp"
 #include "BDDFormulaBuilder.hpp"
+#include "DualModel.hpp"
 
 // Nothing interesting in here.
 // Go deep down in the Conditions.cpp
 
 namespace conditions
 {
-  void addConditions(bddHelper::BDDHelper &h, BDDFormulaBuilder &builder);
-}
\ No newline at end of file
+  // How "each value is used by one object" is said, see addUniqueCondition
+  enum class Uniqueness
+  {
+    PAIRWISE,     // notEqual for each pair of objects
+    ALL_DIFFERENT // One allDifferent condition for each property
+  };
+
+  /**
+   * With dual model conditions about places of values (loops and
+   * neighbours) are said with its positions, see DualModel.hpp.
+   * Formula then has variables of both models. Uniqueness is not used
+   * then: values are unique because each value has one position.
+   */
+  void addConditions(bddHelper::BDDHelper &h, BDDFormulaBuilder &builder,
+                     Uniqueness uniqueness = Uniqueness::PAIRWISE,
+                     dualModel::DualModel *dual = nullptr);
+
+  // See Conditions.cpp file
+  bdd allDifferent(bddHelper::BDDHelper &h, bddHelper::Property prop);
+}
+
+#endif
@@ -0,0 +1,114 @@
+#include "DualModel.hpp"
+#include <ranges>
+
+namespace dualModel
+{
+  /**
+   * Create position variables for each property value.
+   * They are placed after variables of h, 4 bits of one position together.
+   * Positions of values with the same number go one after another:
+   * loop conditions link exactly them (UKRAINE lives with DOG, MALINA, RED),
+   * so formula has to remember only which positions are used.
+   * With positions of one property together it has to remember
+   * whole permutation, that's hundreds of thousands nodes.
+   */
+  DualModel::DualModel(BDDHelper &h) :
+    h_(h)
+  {
+    auto first = bdd_extvarnum(BDDHelper::nProps * BDDHelper::nVals * BDDHelper::nValueBits);
+    positions_ = std::vector< std::vector< bvec > >(BDDHelper::nProps);
+    for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+      for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+      {
+        std::vector< int > varNums;
+        for (auto bit : std::views::iota(0, BDDHelper::nValueBits))
+          varNums.push_back(first + (valNum * BDDHelper::nProps + propNum) * BDDHelper::nValueBits + bit);
+        dualVars_.insert(dualVars_.end(), varNums.begin(), varNums.end());
+        positions_[propNum].push_back(bvec_varvec(BDDHelper::nValueBits, varNums.data()));
+      }
+  }
+
+  /**
+   * Number of object that has value valNum of property prop.
+   * Objects are numbered as in getNeighbour_: x + y * 3.
+   */
+  bvec DualModel::getPosition(Property prop, int valNum) const
+  {
+    assert(("Bad value", valNum >= 0 and valNum < BDDHelper::nVals));
+    return positions_[bddHelper::toNum(prop)][valNum];
+  }
+
+  // Value valNum of property prop is at object obj
+  bdd DualModel::isAt(Property prop, int valNum, Object obj) const
+  {
+    return getPosition(prop, valNum) == bvec(BDDHelper::nValueBits, bddHelper::toNum(obj));
+  }
+
+  // Position is number of object, so it's less than 9
+  bdd DualModel::getPositionBound(Property prop, int valNum) const
+  {
+    return getPosition(prop, valNum) < bvec(BDDHelper::nValueBits, BDDHelper::nObjs);
+  }
+
+  /**
+   * Conditions that tie models together:
+   *    object has value <=> position of value is the object
+   * One condition for each property value.
+   * When positions of property values are all different, each object
+   * gets exactly one value, so BDDHelper variables are fully determined.
+   * Join them when positions are already known - before that formula
+   * has to remember each possible position of each value.
+   */
+  std::vector< bdd > DualModel::getChanneling()
+  {
+    std::vector< bdd > conditions;
+    for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+    {
+      auto prop = static_cast< Property >(propNum);
+      for (auto valNum : std::views::iota(0, BDDHelper::nVals))
+      {
+        auto condition = bdd_true();
+        for (auto objNum : std::views::iota(0, BDDHelper::nObjs))
+        {
+          auto obj = static_cast< Object >(objNum);
+          condition &= bdd_biimp(h_.getObjectVal(obj, prop, valNum), isAt(prop, valNum, obj));
+        }
+        conditions.push_back(condition);
+      }
+    }
+    return conditions;
+  }
+
+  // Variables of BDDHelper as variables set
+  bdd DualModel::getPrimaryVarSet() const
+  {
+    auto varSet = bdd_true();
+    for (auto propNum : std::views::iota(0, BDDHelper::nProps))
+      varSet &= h_.getPropertyVarSet(static_cast< Property >(propNum));
+    return varSet;
+  }
+
+  // Position variables as variables set
+  bdd DualModel::getDualVarSet() const
+  {
+    auto varNums = dualVars_;
+    return bdd_makeset(varNums.data(), static_cast< int >(varNums.size()));
+  }
+
+  /**
+   * Formula with both models says the same with each of them,
+   * because of channeling. So queries may use the smaller one:
+   * other model's variables are quantified out, and we return
+   * the formula and its variables set (for bdd_satcountset and so on).
+   */
+  std::pair< bdd, bdd > DualModel::smallerModel(const bdd &formula) const
+  {
+    auto primaryVars = getPrimaryVarSet();
+    auto dualVars = getDualVarSet();
+    auto primary = bdd_exist(formula, dualVars);
+    auto dual = bdd_exist(formula, primaryVars);
+    if (bdd_nodecount(dual) < bdd_nodecount(primary))
+      return { dual, dualVars };
+    return { primary, primaryVars };
+  }
+}
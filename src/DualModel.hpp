@@ -0,0 +1,89 @@
+#ifndef DUAL_MODEL_HPP
+#define DUAL_MODEL_HPP
+
+#include <vector>
+#include "bdd.h"
+#include "bvec.h"
+#include "BDDHelper.hpp"
+
+/**
+ * Dual model of the puzzle.
+ * BDDHelper says which value each object has. Here we say
+ * which object (position) each value has: 4 bits number 0..8,
+ * for example position of Nation::UKRAINE.
+ *
+ * Conditions about places of values, like neighbours, become
+ * relations of two positions, 8 variables only, instead of
+ * OR over all the objects.
+ *
+ * Puzzle is solved in dual model, then channeling conditions
+ * (see getChanneling) give values of BDDHelper variables, so
+ * formula has both models and they say the same.
+ */
+namespace dualModel
+{
+  using bddHelper::BDDHelper;
+  using bddHelper::Object;
+  using bddHelper::Property;
+
+  class DualModel
+  {
+  public:
+    // See DualModel.cpp file
+    DualModel(BDDHelper &h);
+
+    // See DualModel.cpp file
+    bvec getPosition(Property prop, int valNum) const;
+
+    // Same as above, but property is taken from value type
+    template < class V_t >
+    bvec getPosition(V_t value) const;
+
+    // See DualModel.cpp file
+    bdd isAt(Property prop, int valNum, Object obj) const;
+
+    /**
+     * Same as BDDHelper::getObjectVal, so conditions can be
+     * written once for both models.
+     */
+    template < class V_t >
+    bdd getObjectVal(Object obj, V_t value) const;
+
+    // See DualModel.cpp file
+    bdd getPositionBound(Property prop, int valNum) const;
+
+    // See DualModel.cpp file
+    std::vector< bdd > getChanneling();
+
+    // See DualModel.cpp file
+    bdd getPrimaryVarSet() const;
+
+    // See DualModel.cpp file
+    bdd getDualVarSet() const;
+
+    // See DualModel.cpp file
+    std::pair< bdd, bdd > smallerModel(const bdd &formula) const;
+
+  private:
+    BDDHelper &h_;
+    // positions_[prop][val], least significant bit first as in bvec.h
+    std::vector< std::vector< bvec > > positions_;
+    std::vector< int > dualVars_;
+  };
+
+  template < class V_t >
+  inline bdd DualModel::getObjectVal(Object obj, V_t value) const
+  {
+    static_assert(bddHelper::traits_::IsValueType_v< V_t >, "Value must be one of properties type");
+    return isAt(bddHelper::traits_::PropertyFromValueEnum_v< V_t >, bddHelper::toNum(value), obj);
+  }
+
+  template < class V_t >
+  inline bvec DualModel::getPosition(V_t value) const
+  {
+    static_assert(bddHelper::traits_::IsValueType_v< V_t >, "Value must be one of properties type");
+    return getPosition(bddHelper::traits_::PropertyFromValueEnum_v< V_t >, bddHelper::toNum(value));
+  }
+}
+
+#endif
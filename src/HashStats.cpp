@@ -0,0 +1,119 @@
+#include "HashStats.hpp"
+#include <unordered_set>
+#include <algorithm>
+
+namespace
+{
+  // Same as PAIR in BuDDy kernel.h, with unsigned overflow
+  std::uint32_t pair(std::uint32_t a, std::uint32_t b)
+  {
+    return (a + b) * (a + b + 1) / 2 + a;
+  }
+
+  // Finalizer of MurmurHash3
+  std::uint32_t mix(std::uint32_t x)
+  {
+    x ^= x >> 16;
+    x *= 0x85ebca6bu;
+    x ^= x >> 13;
+    x *= 0xc2b2ae35u;
+    x ^= x >> 16;
+    return x;
+  }
+}
+
+namespace hashStats
+{
+  // Bucket number before % table size
+  std::uint32_t hash(Hash kind, const NodeKey &key)
+  {
+    auto level = static_cast< std::uint32_t >(key.level);
+    auto low = static_cast< std::uint32_t >(key.low);
+    auto high = static_cast< std::uint32_t >(key.high);
+    if (kind == Hash::BUDDY)
+      return pair(high, pair(level, low)); // TRIPLE(level, low, high)
+    return mix(mix(mix(level) ^ low) ^ high);
+  }
+
+  /**
+   * Nodes of all formulas, each once. Constants are not in unique table.
+   * Levels are taken from current variables order, as BuDDy keeps them.
+   */
+  std::vector< NodeKey > collectKeys(const std::vector< bdd > &formulas)
+  {
+    std::vector< NodeKey > keys;
+    std::unordered_set< int > seen;
+    std::vector< int > stack;
+    for (auto &formula : formulas)
+      stack.push_back(formula.id());
+    while (not stack.empty())
+    {
+      auto node = stack.back();
+      stack.pop_back();
+      if (node < 2 or not seen.insert(node).second)
+        continue;
+      keys.push_back({ bdd_var2level(bdd_var(node)), bdd_low(node), bdd_high(node) });
+      stack.push_back(bdd_low(node));
+      stack.push_back(bdd_high(node));
+    }
+    return keys;
+  }
+
+  /**
+   * Put keys into nBuckets chains by hash % nBuckets.
+   * Looking for k-th node of chain walks k nodes.
+   */
+  ChainStats chainStats(const std::vector< NodeKey > &keys, std::size_t nBuckets, Hash kind)
+  {
+    ChainStats stats;
+    stats.nNodes = keys.size();
+    stats.nBuckets = nBuckets;
+    std::vector< std::size_t > chains(nBuckets, 0);
+    std::size_t walked = 0;
+    for (auto &key : keys)
+      walked += ++chains[hash(kind, key) % nBuckets];
+    stats.usedBuckets = nBuckets - std::ranges::count(chains, 0);
+    stats.maxChain = std::ranges::max(chains);
+    stats.avgProbe = keys.empty() ? 0 : static_cast< double >(walked) / keys.size();
+    stats.randomProbe = 1 + static_cast< double >(keys.size()) / nBuckets / 2;
+    return stats;
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include "TestFixture.hpp"
+
+TEST(HashStats, chains)
+{
+  using namespace hashStats;
+  // TRIPLE(level, low, high) is PAIR(high, PAIR(level, low)),
+  // Cantor pairing: (0,0) -> 0, (1,0) -> 2, (0,2) -> 3, (1,1) -> 4, (0,4) -> 10
+  EXPECT_EQ(hash(Hash::BUDDY, { 0, 0, 1 }), 2u);
+  EXPECT_EQ(hash(Hash::BUDDY, { 1, 0, 0 }), 3u);
+  EXPECT_EQ(hash(Hash::BUDDY, { 1, 1, 0 }), 10u);
+  // Nodes in the same bucket make chain
+  std::vector< NodeKey > keys = { { 0, 0, 1 }, { 0, 0, 1 }, { 1, 1, 0 } };
+  auto stats = chainStats(keys, 1000, Hash::BUDDY);
+  EXPECT_EQ(stats.nNodes, 3);
+  EXPECT_EQ(stats.usedBuckets, 2);
+  EXPECT_EQ(stats.maxChain, 2);
+  EXPECT_DOUBLE_EQ(stats.avgProbe, 4.0 / 3);
+}
+
+TEST_F(VarsSetupFixture, HashStats_CollectKeys)
+{
+  using namespace bddHelper;
+  auto first = h.getObjectVal(Object::FIRST, Color::RED);
+  auto both = first & h.getObjectVal(Object::SECOND, Color::RED);
+  // Nodes of first are shared with both, so they are counted once
+  auto keys = hashStats::collectKeys({ first, both });
+  std::vector< bdd > formulas = { first, both };
+  EXPECT_EQ(static_cast< int >(keys.size()), bdd_anodecount(formulas.data(), 2));
+  // Key has level and children as BuDDy has them
+  EXPECT_TRUE(std::ranges::any_of(keys, [&both](const hashStats::NodeKey &key) {
+    return key.level == bdd_var2level(bdd_var(both)) and key.low == bdd_low(both).id() and key.high == bdd_high(both).id();
+  }));
+}
+
+#endif
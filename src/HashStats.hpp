@@ -0,0 +1,58 @@
+#ifndef HASH_STATS_HPP
+#define HASH_STATS_HPP
+
+#include <vector>
+#include <cstdint>
+#include "bdd.h"
+
+/**
+ * How well nodes of our formulas spread over BuDDy unique table.
+ *
+ * BuDDy finds node (level, low, high) in hash table with chains,
+ * bucket is TRIPLE(level, low, high) % table size, where TRIPLE(a, b, c)
+ * is PAIR(c, PAIR(a, b)) of Cantor pairing, and table size is prime. Pairing of close numbers gives close
+ * numbers, and our nodes are made of close ones: bits of one value
+ * are on neighbour levels and their nodes are created together.
+ * BuDDy is prebuilt without its CACHESTATS counters, so here we put
+ * the same nodes into the same table again, with BuDDy hash and with
+ * well mixing one, and count chains.
+ */
+namespace hashStats
+{
+  // Node as unique table sees it: level and BuDDy numbers of children
+  struct NodeKey
+  {
+    int level;
+    int low;
+    int high;
+  };
+
+  enum class Hash
+  {
+    BUDDY, // TRIPLE(level, low, high) from BuDDy kernel.h
+    MIX    // Multiply and xor-shift, every input bit changes every output bit
+  };
+
+  struct ChainStats
+  {
+    std::size_t nNodes = 0;
+    std::size_t nBuckets = 0;
+    std::size_t usedBuckets = 0;
+    std::size_t maxChain = 0;
+    // Chain nodes walked to find a node, average over all nodes
+    double avgProbe = 0;
+    // Same for uniformly random hash: 1 + nodes / buckets / 2
+    double randomProbe = 0;
+  };
+
+  // See HashStats.cpp file
+  std::uint32_t hash(Hash kind, const NodeKey &key);
+
+  // See HashStats.cpp file
+  std::vector< NodeKey > collectKeys(const std::vector< bdd > &formulas);
+
+  // See HashStats.cpp file
+  ChainStats chainStats(const std::vector< NodeKey > &keys, std::size_t nBuckets, Hash kind);
+}
+
+#endif
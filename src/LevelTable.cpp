@@ -0,0 +1,405 @@
+#include "LevelTable.hpp"
+#include "NodeTable.hpp"
+#include <algorithm>
+#include <numeric>
+#include <ranges>
+#include <utility>
+#include <unordered_map>
+#include <bit>
+
+namespace
+{
+  // Subtable has a bucket per node, but no less than that
+  constexpr std::size_t minBuckets = 4;
+
+  // Fibonacci hashing of both children, high bits are the best mixed
+  std::size_t childrenHash(int low, int high)
+  {
+    auto key = static_cast< std::uint64_t >(static_cast< std::uint32_t >(low)) << 32 | static_cast< std::uint32_t >(high);
+    return static_cast< std::size_t >((key * 0x9e3779b97f4a7c15ull) >> 32);
+  }
+}
+
+namespace levelTable
+{
+  /**
+   * Copy nodes of formulas, each node once.
+   * Levels are taken from current BuDDy order.
+   * Each formula holds a reference to its root, so its nodes live
+   * as long as the table does.
+   */
+  LevelTable::LevelTable(const std::vector< bdd > &formulas) :
+    levels_(2, bdd_varnum()),
+    lows_(2, -1),
+    highs_(2, -1),
+    next_(2, -1),
+    refs_(2, 0),
+    subtables_(bdd_varnum(), Subtable{ std::vector< int >(minBuckets, -1), 0 })
+  {
+    for (auto level : std::views::iota(0, bdd_varnum()))
+      order_.push_back(bdd_level2var(level));
+    // Find all nodes with our own stack, children are created before parents
+    std::unordered_map< int, int > index = { { 0, 0 }, { 1, 1 } };
+    std::vector< std::pair< int, int > > byLevel;
+    std::vector< int > stack;
+    for (auto &formula : formulas)
+      stack.push_back(formula.id());
+    while (not stack.empty())
+    {
+      auto node = stack.back();
+      stack.pop_back();
+      if (not index.emplace(node, -1).second)
+        continue;
+      byLevel.emplace_back(nodeTable::nodeLevel(node), node);
+      stack.push_back(bdd_low(node));
+      stack.push_back(bdd_high(node));
+    }
+    std::ranges::sort(byLevel, std::greater<>());
+    for (auto [level, node] : byLevel)
+      index[node] = makeNode(level, index[bdd_low(node)], index[bdd_high(node)]);
+    for (auto &formula : formulas)
+      ref(index[formula.id()]);
+    // makeNode gave each node a reference, parents and formulas have their own
+    for (auto [level, node] : byLevel)
+      deref(index[node]);
+  }
+
+  int LevelTable::size() const
+  {
+    return size_;
+  }
+
+  int LevelTable::nLevels() const
+  {
+    return static_cast< int >(subtables_.size());
+  }
+
+  int LevelTable::levelSize(int level) const
+  {
+    return subtables_[level].size;
+  }
+
+  const std::vector< int > &LevelTable::order() const
+  {
+    return order_;
+  }
+
+  /**
+   * Exchange variables of level and level + 1, formulas stay the same.
+   * Say x is on level and y is below it. Nodes of y just go up.
+   * Nodes of x that have no y children just go down. Other node f of x
+   * becomes node of y, in place, so its parents don't change:
+   * f = x ? (y ? f11 : f10) : (y ? f01 : f00) = y ? (x ? f11 : f01) : (x ? f10 : f00),
+   * and its new children are nodes of x on level + 1.
+   * Nodes of y that nobody points to anymore are freed.
+   * Only subtables of these two levels are touched.
+   */
+  void LevelTable::swap(int level)
+  {
+    auto lower = level + 1;
+    std::vector< int > stay;
+    std::vector< int > goDown;
+    for (auto node : levelNodes(level))
+    {
+      auto dependsOnLower = levels_[lows_[node]] == lower or levels_[highs_[node]] == lower;
+      (dependsOnLower ? stay : goDown).push_back(node);
+    }
+    // Subtable of y goes up as it is, hash doesn't depend on level
+    std::swap(subtables_[level], subtables_[lower]);
+    for (auto node : levelNodes(level))
+      levels_[node] = level;
+    auto &xTable = subtables_[lower];
+    xTable.buckets.assign(std::bit_ceil(std::max(goDown.size() + stay.size(), minBuckets)), -1);
+    xTable.size = 0;
+    for (auto node : goDown)
+    {
+      levels_[node] = lower;
+      insert(node);
+    }
+    // Nodes of y went up, so now they are on level
+    auto cofactors = [this, level](int node) {
+      return levels_[node] == level ? std::pair(lows_[node], highs_[node]) : std::pair(node, node);
+    };
+    for (auto node : stay)
+    {
+      auto [f00, f01] = cofactors(lows_[node]);
+      auto [f10, f11] = cofactors(highs_[node]);
+      auto oldLow = lows_[node];
+      auto oldHigh = highs_[node];
+      lows_[node] = makeNode(lower, f00, f10);
+      highs_[node] = makeNode(lower, f01, f11);
+      deref(oldLow);
+      deref(oldHigh);
+      insert(node);
+    }
+    fit(level);
+    fit(lower);
+    std::swap(order_[level], order_[lower]);
+  }
+
+  // Find or create node, it gets one more reference
+  int LevelTable::makeNode(int level, int low, int high)
+  {
+    if (low == high)
+    {
+      ref(low);
+      return low;
+    }
+    for (auto node = bucket(level, low, high); node >= 0; node = next_[node])
+      if (lows_[node] == low and highs_[node] == high)
+      {
+        ref(node);
+        return node;
+      }
+    int node = static_cast< int >(levels_.size());
+    if (not freeNodes_.empty())
+    {
+      node = freeNodes_.back();
+      freeNodes_.pop_back();
+    }
+    else
+    {
+      levels_.push_back(0);
+      lows_.push_back(0);
+      highs_.push_back(0);
+      next_.push_back(-1);
+      refs_.push_back(0);
+    }
+    levels_[node] = level;
+    lows_[node] = low;
+    highs_[node] = high;
+    refs_[node] = 1;
+    ref(low);
+    ref(high);
+    insert(node);
+    if (static_cast< std::size_t >(subtables_[level].size) > subtables_[level].buckets.size())
+      fit(level);
+    ++size_;
+    return node;
+  }
+
+  void LevelTable::ref(int node)
+  {
+    if (node >= 2)
+      ++refs_[node];
+  }
+
+  // Node nobody points to is removed, and so are its children left without parents
+  void LevelTable::deref(int node)
+  {
+    if (node < 2 or --refs_[node] > 0)
+      return;
+    erase(node);
+    freeNodes_.push_back(node);
+    --size_;
+    deref(lows_[node]);
+    deref(highs_[node]);
+  }
+
+  // Head of chain where node with these children is on level
+  int &LevelTable::bucket(int level, int low, int high)
+  {
+    auto &buckets = subtables_[level].buckets;
+    return buckets[childrenHash(low, high) & (buckets.size() - 1)];
+  }
+
+  void LevelTable::insert(int node)
+  {
+    auto &head = bucket(levels_[node], lows_[node], highs_[node]);
+    next_[node] = head;
+    head = node;
+    ++subtables_[levels_[node]].size;
+  }
+
+  void LevelTable::erase(int node)
+  {
+    auto *link = &bucket(levels_[node], lows_[node], highs_[node]);
+    while (*link != node)
+      link = &next_[*link];
+    *link = next_[node];
+    --subtables_[levels_[node]].size;
+  }
+
+  void LevelTable::resize(int level, int nBuckets)
+  {
+    auto nodes = levelNodes(level);
+    subtables_[level].buckets.assign(nBuckets, -1);
+    subtables_[level].size = 0;
+    for (auto node : nodes)
+      insert(node);
+  }
+
+  // About a bucket per node: grow when level has more nodes, shrink when much less
+  void LevelTable::fit(int level)
+  {
+    auto &subtable = subtables_[level];
+    auto wanted = std::bit_ceil(std::max(static_cast< std::size_t >(subtable.size), minBuckets));
+    if (wanted > subtable.buckets.size() or wanted * 4 < subtable.buckets.size())
+      resize(level, static_cast< int >(wanted));
+  }
+
+  std::vector< int > LevelTable::levelNodes(int level) const
+  {
+    std::vector< int > nodes;
+    nodes.reserve(subtables_[level].size);
+    for (auto head : subtables_[level].buckets)
+      for (auto node = head; node >= 0; node = next_[node])
+        nodes.push_back(node);
+    return nodes;
+  }
+
+  /**
+   * Sifting of blocks, like BuDDy does it with fixed variable blocks.
+   * blocks cover all levels from the first one. Each movable block,
+   * the biggest first, is moved down to the last place and then up
+   * to the first one, and is left where table had the least nodes.
+   * Block goes in one direction only while table is no more than
+   * maxGrowth times bigger than the best size.
+   * Returns how many times levels were swapped.
+   */
+  int siftBlocks(LevelTable &table, const std::vector< Block > &blocks, double maxGrowth)
+  {
+    // Block numbers in their current order
+    std::vector< int > placed(blocks.size());
+    std::iota(placed.begin(), placed.end(), 0);
+    int nSwaps = 0;
+    auto startLevel = [&blocks, &placed](int pos) {
+      int level = 0;
+      for (auto i : std::views::iota(0, pos))
+        level += blocks[placed[i]].nLevels;
+      return level;
+    };
+    // Block on pos and the one below exchange places, levels inside them keep their order
+    auto moveDown = [&](int pos) {
+      auto start = startLevel(pos);
+      auto upper = blocks[placed[pos]].nLevels;
+      auto lower = blocks[placed[pos + 1]].nLevels;
+      for (auto k : std::views::iota(0, lower))
+        for (auto level = start + upper + k - 1; level >= start + k; --level)
+        {
+          table.swap(level);
+          ++nSwaps;
+        }
+      std::swap(placed[pos], placed[pos + 1]);
+    };
+
+    std::vector< std::pair< int, int > > bySize;
+    for (auto pos : std::views::iota(0, static_cast< int >(blocks.size())))
+    {
+      if (not blocks[pos].movable)
+        continue;
+      int nodes = 0;
+      auto start = startLevel(pos);
+      for (auto level : std::views::iota(start, start + blocks[pos].nLevels))
+        nodes += table.levelSize(level);
+      bySize.emplace_back(nodes, pos);
+    }
+    std::ranges::sort(bySize, std::greater<>());
+
+    auto nBlocks = static_cast< int >(blocks.size());
+    for (auto [nodes, block] : bySize)
+    {
+      auto pos = static_cast< int >(std::ranges::find(placed, block) - placed.begin());
+      auto best = table.size();
+      auto bestPos = pos;
+      auto note = [&]() {
+        if (table.size() < best)
+        {
+          best = table.size();
+          bestPos = pos;
+        }
+        return table.size() <= maxGrowth * best;
+      };
+      while (pos + 1 < nBlocks)
+      {
+        moveDown(pos++);
+        if (not note())
+          break;
+      }
+      while (pos > 0)
+      {
+        moveDown(--pos);
+        if (not note())
+          break;
+      }
+      while (pos < bestPos)
+        moveDown(pos++);
+      while (pos > bestPos)
+        moveDown(--pos);
+    }
+    return nSwaps;
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include <random>
+#include "TestFixture.hpp"
+
+TEST_F(VarsSetupFixture, LevelTable_Swap)
+{
+  using namespace bddHelper;
+  std::vector< bdd > formulas = {
+    (h.getObjectVal(Object::FIRST, Color::RED) | h.getObjectVal(Object::THIRD, Color::GREEN)) &
+      not h.getObjectVal(Object::SECOND, Nation::CHINA),
+    bdd_biimp(v[0][0][0], v[1][0][3]) & bdd_xor(v[0][1][2], v[2][0][1]),
+    h.getObjectVal(Object::FIRST, Color::RED),
+    bdd_true()
+  };
+  levelTable::LevelTable table(formulas);
+  EXPECT_EQ(table.size(), bdd_anodecount(formulas.data(), static_cast< int >(formulas.size())));
+  // After any swaps table has as many nodes as BuDDy has in the same order
+  std::mt19937 random(1);
+  std::uniform_int_distribution< int > level(0, 3 * nProps * nValueBits - 1);
+  for (auto step : std::views::iota(0, 200))
+  {
+    table.swap(level(random));
+    if (step % 20 != 0)
+      continue;
+    auto order = table.order();
+    bdd_setvarorder(order.data());
+    EXPECT_EQ(table.size(), bdd_anodecount(formulas.data(), static_cast< int >(formulas.size())));
+    auto levelsSum = 0;
+    for (auto l : std::views::iota(0, table.nLevels()))
+      levelsSum += table.levelSize(l);
+    EXPECT_EQ(levelsSum, table.size());
+  }
+  // Other tests expect variable number to be its level
+  std::vector< int > order(nTotalVars);
+  std::iota(order.begin(), order.end(), 0);
+  bdd_setvarorder(order.data());
+  EXPECT_EQ(bdd_var2level(nTotalVars - 1), nTotalVars - 1);
+}
+
+TEST_F(VarsSetupFixture, LevelTable_SiftBlocks)
+{
+  using namespace bddHelper;
+  // Colors of FIRST and FOURTH objects are equal, and so are colors of SECOND
+  // and THIRD. With groups in objects order all bits of FIRST and SECOND are
+  // remembered before the third object, next to each other they are not.
+  auto joined = bdd_true();
+  for (auto bit : std::views::iota(0, nValueBits))
+    joined &= bdd_biimp(v[0][0][bit], v[3][0][bit]) & bdd_biimp(v[1][0][bit], v[2][0][bit]);
+  std::vector< bdd > formulas = { joined };
+  auto before = bdd_nodecount(joined);
+  levelTable::LevelTable table(formulas);
+  std::vector< levelTable::Block > blocks(nObjs * nProps, { nValueBits, true });
+  EXPECT_GT(levelTable::siftBlocks(table, blocks), 0);
+  EXPECT_LT(table.size(), before);
+  // Bits of each group are still together and in the same order
+  auto order = table.order();
+  for (auto level = 0; level < nTotalVars; level += nValueBits)
+    for (auto bit : std::views::iota(1, nValueBits))
+      EXPECT_EQ(order[level + bit], order[level] + bit);
+  bdd_setvarorder(order.data());
+  EXPECT_EQ(bdd_nodecount(joined), table.size());
+  // Block that is not movable stays where it is
+  std::iota(order.begin(), order.end(), 0);
+  bdd_setvarorder(order.data());
+  levelTable::LevelTable pinned(formulas);
+  blocks.assign(nObjs * nProps, { nValueBits, false });
+  EXPECT_EQ(levelTable::siftBlocks(pinned, blocks), 0);
+  EXPECT_EQ(pinned.order(), order);
+}
+
+#endif
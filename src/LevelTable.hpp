@@ -0,0 +1,82 @@
+#ifndef LEVEL_TABLE_HPP
+#define LEVEL_TABLE_HPP
+
+#include <vector>
+#include <cstdint>
+#include "bdd.h"
+
+/**
+ * Copy of formula nodes with unique table of its own for each level,
+ * made for sifting variables.
+ *
+ * BuDDy also splits its table by levels while reordering, but every
+ * level gets nodes table size / variables count buckets, whatever number
+ * of nodes it has, and swap of two levels walks all their buckets.
+ * So its reordering time grows with table size, not with live nodes.
+ * Here each level has hash table of its own, sized by nodes of this
+ * level only, and swapping two neighbour levels touches only these two.
+ * Order found here is set to BuDDy once with bdd_setvarorder.
+ */
+namespace levelTable
+{
+  class LevelTable
+  {
+  public:
+    // See LevelTable.cpp file
+    explicit LevelTable(const std::vector< bdd > &formulas);
+
+    // Nodes of all formulas, constants are not counted
+    int size() const;
+    int nLevels() const;
+    // Nodes on level
+    int levelSize(int level) const;
+    // Variables from the first level to the last one, as bdd_setvarorder takes them
+    const std::vector< int > &order() const;
+
+    // See LevelTable.cpp file
+    void swap(int level);
+
+  private:
+    // Unique table of one level: chains of nodes with the same hash of children
+    struct Subtable
+    {
+      std::vector< int > buckets; // First node of chain, -1 if chain is empty
+      int size = 0;
+    };
+
+    int makeNode(int level, int low, int high);
+    void ref(int node);
+    void deref(int node);
+    int &bucket(int level, int low, int high);
+    void insert(int node);
+    void erase(int node);
+    void resize(int level, int nBuckets);
+    void fit(int level);
+    std::vector< int > levelNodes(int level) const;
+
+    // Fields of node. Nodes 0 and 1 are constants, their level is nLevels().
+    std::vector< int > levels_;
+    std::vector< int > lows_;
+    std::vector< int > highs_;
+    // Next node in chain of the same bucket
+    std::vector< int > next_;
+    // Parents and formulas that point to node. Node with 0 is freed.
+    std::vector< int > refs_;
+    std::vector< int > freeNodes_;
+    std::vector< Subtable > subtables_;
+    std::vector< int > order_;
+    int size_ = 0;
+  };
+
+  // Levels that move only together and keep their order
+  struct Block
+  {
+    int nLevels = 1;
+    bool movable = true; // Not movable blocks are not sifted, but others move over them
+  };
+
+  // See LevelTable.cpp file
+  int siftBlocks(LevelTable &table, const std::vector< Block > &blocks, double maxGrowth = 1.2);
+}
+
+#endif
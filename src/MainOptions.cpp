@@ -0,0 +1,186 @@
+#include "MainOptions.hpp"
+#include <string_view>
+#include "Arguments.hpp"
+
+namespace
+{
+  using namespace mainOptions;
+
+  // Names of strategies for --schedule option.
+  // Names shared with other tools are in Arguments.hpp.
+  constexpr arguments::Name< BDDFormulaBuilder::Strategy > strategyNames[] = {
+    { "sequential", BDDFormulaBuilder::Strategy::SEQUENTIAL },
+    { "cluster", BDDFormulaBuilder::Strategy::SUPPORT_CLUSTER }
+  };
+
+  // Names of properties for --project option
+  constexpr arguments::Name< Property > propertyNames[] = {
+    { "color", Property::COLOR },
+    { "nation", Property::NATION },
+    { "plant", Property::PLANT },
+    { "animal", Property::ANIMAL }
+  };
+
+  // Names of reordering methods for --reorder option
+  constexpr arguments::Name< int > reorderNames[] = {
+    { "sift", BDD_REORDER_SIFT },
+    { "siftite", BDD_REORDER_SIFTITE },
+    { "win2ite", BDD_REORDER_WIN2ITE },
+    { "win3ite", BDD_REORDER_WIN3ITE }
+  };
+}
+
+namespace mainOptions
+{
+  std::optional< Options > parseOptions(int argc, const char *const argv[])
+  {
+    Options options;
+    bool isUniqueGiven = false;
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string_view arg = argv[i];
+      if (arg == "--all")
+        options.all = true;
+      else if (arg == "--marginals")
+        options.marginals = true;
+      else if (arg == "--backbone")
+        options.backbone = true;
+      else if (arg == "--peak")
+        options.peak = true;
+      else if (arg == "--schedule" and i + 1 < argc)
+      {
+        auto value = arguments::parseName(strategyNames, argv[++i]);
+        if (not value)
+          return std::nullopt;
+        options.strategy = *value;
+      }
+      else if (arg == "--project" and i + 1 < argc)
+      {
+        auto value = arguments::parseName(propertyNames, argv[++i]);
+        if (not value)
+          return std::nullopt;
+        options.project = *value;
+      }
+      else if (arg == "--order" and i + 1 < argc)
+      {
+        auto value = arguments::parseName(arguments::orderNames, argv[++i]);
+        if (not value)
+          return std::nullopt;
+        options.order = *value;
+      }
+      else if (arg == "--encoding" and i + 1 < argc)
+      {
+        auto value = arguments::parseName(arguments::encodingNames, argv[++i]);
+        if (not value)
+          return std::nullopt;
+        options.encoding = *value;
+      }
+      else if (arg == "--unique" and i + 1 < argc)
+      {
+        auto value = arguments::parseName(arguments::uniquenessNames, argv[++i]);
+        if (not value)
+          return std::nullopt;
+        options.uniqueness = *value;
+        isUniqueGiven = true;
+      }
+      else if (arg == "--reorder" and i + 1 < argc)
+      {
+        // One way of reordering: the last --reorder wins.
+        // BuDDy reordering needs variable blocks and our sifting can't work with them.
+        std::string_view name = argv[++i];
+        auto method = arguments::parseName(reorderNames, name);
+        if (name != "groups" and not method)
+          return std::nullopt;
+        options.siftGroups = name == "groups";
+        options.reorderMethod = method.value_or(BDD_REORDER_NONE);
+      }
+      else if (arg == "--reorder-times" and i + 1 < argc)
+      {
+        auto times = arguments::parseNumber< int >(argv[++i]);
+        if (not times or *times < 0)
+          return std::nullopt;
+        options.reorderTimes = *times;
+      }
+      else if (arg == "--dual")
+        options.dual = true;
+      else if (arg == "--force-order")
+        options.forceOrder = true;
+      else if (arg == "--huge-pages")
+        options.hugePages = true;
+      else if (arg == "--order-file" and i + 1 < argc)
+        options.orderFile = argv[++i];
+      else if (arg == "--nodes" and i + 1 < argc)
+      {
+        auto nodes = arguments::parseNumber< int >(argv[++i]);
+        if (not nodes or *nodes <= 0)
+          return std::nullopt;
+        options.nodes = *nodes;
+      }
+      else if (arg == "--cache" and i + 1 < argc)
+      {
+        auto cacheSize = arguments::parseNumber< int >(argv[++i]);
+        if (not cacheSize or *cacheSize <= 0)
+          return std::nullopt;
+        options.cacheSize = *cacheSize;
+      }
+      else if (arg == "--split" and i + 1 < argc)
+      {
+        options.all = true;
+        auto splitLevels = arguments::parseNumber< int >(argv[++i]);
+        if (not splitLevels or *splitLevels < 0 or *splitLevels > 16)
+          return std::nullopt;
+        options.splitLevels = *splitLevels;
+      }
+      else if (arg == "--shards" and i + 1 < argc)
+        options.shardsPrefix = argv[++i];
+      else
+        return std::nullopt;
+    }
+    // Without --split there are no shards
+    if (not options.shardsPrefix.empty() and options.splitLevels == 0)
+      return std::nullopt;
+    // Dual model has uniqueness conditions of its own, see DualModel.hpp
+    if (options.dual and isUniqueGiven)
+      return std::nullopt;
+    return options;
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+  // argv as bdd_main gets it
+  std::optional< Options > parse(std::vector< const char * > args)
+  {
+    args.insert(args.begin(), "bdd_main");
+    return parseOptions(static_cast< int >(args.size()), args.data());
+  }
+}
+
+TEST(MainOptions, Reorder)
+{
+  auto groups = parse({ "--reorder", "sift", "--reorder", "groups" });
+  ASSERT_TRUE(groups.has_value());
+  EXPECT_TRUE(groups->siftGroups);
+  EXPECT_EQ(groups->reorderMethod, BDD_REORDER_NONE);
+  auto sift = parse({ "--reorder", "groups", "--reorder", "sift" });
+  ASSERT_TRUE(sift.has_value());
+  EXPECT_FALSE(sift->siftGroups);
+  EXPECT_EQ(sift->reorderMethod, BDD_REORDER_SIFT);
+  EXPECT_FALSE(parse({ "--reorder", "groups", "--reorder", "bad" }).has_value());
+  EXPECT_FALSE(parse({ "--reorder" }).has_value());
+}
+
+TEST(MainOptions, Combinations)
+{
+  EXPECT_TRUE(parse({}).has_value());
+  EXPECT_FALSE(parse({ "--shards", "x" }).has_value());
+  EXPECT_TRUE(parse({ "--split", "2", "--shards", "x" }).has_value());
+  EXPECT_FALSE(parse({ "--dual", "--unique", "alldiff" }).has_value());
+  EXPECT_FALSE(parse({ "--split", "17" }).has_value());
+}
+
+#endif
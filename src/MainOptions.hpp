@@ -0,0 +1,97 @@
+#ifndef MAIN_OPTIONS_HPP
+#define MAIN_OPTIONS_HPP
+
+#include <optional>
+#include <string>
+#include "bdd.h"
+#include "BDDHelper.hpp"
+#include "BDDFormulaBuilder.hpp"
+#include "Conditions.hpp"
+
+// Command line options of bdd_main, see main.cpp
+namespace mainOptions
+{
+  using bddHelper::Property;
+  using bddHelper::VarOrder;
+  using bddHelper::Encoding;
+
+  /**
+   * Command line options.
+   * By default we count combinations and print one of them.
+   *
+   * --all          Print all the combinations.
+   * --split K      Print all the combinations in several threads.
+   *                Formula is split on its first K variables into 2^K parts,
+   *                threads take parts one by one. Output order is the same as with --all.
+   * --shards NAME  Used with --split. Write part i to file NAMEi
+   *                instead of printing everything to the screen.
+   * --marginals    Print for each object property value how many
+   *                combinations have it.
+   * --backbone     Print which object property values are already determined.
+   * --schedule S   How conditions are joined: sequential or cluster.
+   *                See BDDFormulaBuilder::Strategy.
+   * --peak         Count live nodes after each join and print the peak.
+   * --project P    Count only different arrangements of property P
+   *                (color, nation, plant or animal). Result formula
+   *                is not built, see BDDFormulaBuilder::project.
+   * --order O      How objects properties bits are placed among variables:
+   *                object, property or bits. See bddHelper::VarOrder.
+   * --reorder M    Let BuDDy reorder variables while conditions are joined.
+   *                M is sift, siftite, win2ite or win3ite. Or groups: sift
+   *                groups ourselves each time formulas being joined double,
+   *                see BDDHelper::siftGroups. It costs as many nodes as
+   *                formulas have, not as BuDDy table has.
+   *                Only one way is used, the last --reorder wins.
+   * --reorder-times N  Reorder no more than N times. Default is 10.
+   * --nodes N      Initial size of BuDDy nodes table. BuDDy reorders only
+   *                when table is full, so smaller table means earlier reordering.
+   * --cache N      Size of BuDDy operations caches. Default is 100000.
+   *                Joining formulas of millions nodes is faster with bigger cache.
+   * --huge-pages   Put BuDDy nodes table on 2 MB pages,
+   *                see BDDManager::useHugePages.
+   * --encoding E  How values are coded: binary (our own), fdd (BuDDy fdd.h)
+   *                or onehot (variable per value).
+   * --unique U    How values are said to be unique: pairwise (notEqual
+   *                for each pair of objects) or alldiff (one condition
+   *                for each property). See conditions::allDifferent.
+   *                Not allowed with --dual.
+   * --dual         Add dual model: position of each value. Loops and
+   *                neighbours are said with positions, see DualModel.hpp.
+   *                Solutions are counted with the smaller model.
+   * --order-file F Set variables order found by bdd_order_search.
+   * --force-order  Compute variables order from conditions before joining them.
+   *                See orderSearch::forceOrder. It's used only if joining
+   *                with it needs less nodes than with current order.
+   */
+  struct Options
+  {
+    bool all = false;
+    bool marginals = false;
+    bool backbone = false;
+    BDDFormulaBuilder::Strategy strategy = BDDFormulaBuilder::Strategy::SEQUENTIAL;
+    bool peak = false;
+    int splitLevels = 0;
+    std::string shardsPrefix;
+    std::optional< Property > project;
+    VarOrder order = VarOrder::OBJECT_MAJOR;
+    Encoding encoding = Encoding::BINARY;
+    conditions::Uniqueness uniqueness = conditions::Uniqueness::PAIRWISE;
+    bool dual = false;
+    int reorderMethod = BDD_REORDER_NONE;
+    bool siftGroups = false;
+    int reorderTimes = 10;
+    int nodes = 3000000;
+    int cacheSize = 100000;
+    bool hugePages = false;
+    std::string orderFile;
+    bool forceOrder = false;
+  };
+
+  /**
+   * Options from command line. Nothing if some option is unknown,
+   * has bad value or can't be used with others: then usage is printed.
+   */
+  std::optional< Options > parseOptions(int argc, const char *const argv[]);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "NaryApply.hpp"
+#include <algorithm>
+#include <ranges>
+#include <cstddef>
+
+namespace
+{
+  /**
+   * Operands are joined in pairs, then pairs of pairs and so on with
+   * BuDDy's own apply. Each formula in the middle is a part of the
+   * result, not a prefix of all operands, so they are small and BuDDy
+   * cache is shared by all of them.
+   */
+  bdd balancedApply(std::vector< bdd > operands, int op, const bdd &absorbing, const bdd &neutral)
+  {
+    std::erase(operands, neutral);
+    if (std::ranges::find(operands, absorbing) != operands.end())
+      return absorbing;
+    // bdd assignment returns copy, so std::ranges algorithms don't take it
+    std::sort(operands.begin(), operands.end(), [](const bdd &a, const bdd &b) { return a.id() < b.id(); });
+    operands.erase(std::unique(operands.begin(), operands.end()), operands.end());
+    if (operands.empty())
+      return neutral;
+    while (operands.size() > 1)
+    {
+      std::vector< bdd > joined;
+      joined.reserve((operands.size() + 1) / 2);
+      for (std::size_t i = 0; i + 1 < operands.size(); i += 2)
+        joined.push_back(bdd_apply(operands[i], operands[i + 1], op));
+      if (operands.size() % 2)
+        joined.push_back(operands.back());
+      operands = std::move(joined);
+    }
+    return operands.front();
+  }
+}
+
+namespace naryApply
+{
+  // operands[0] & operands[1] & ... True if there are no operands.
+  bdd conjunction(std::vector< bdd > operands)
+  {
+    return balancedApply(std::move(operands), bddop_and, bdd_false(), bdd_true());
+  }
+
+  // operands[0] | operands[1] | ... False if there are no operands.
+  bdd disjunction(std::vector< bdd > operands)
+  {
+    return balancedApply(std::move(operands), bddop_or, bdd_true(), bdd_false());
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include <functional>
+#include <numeric>
+#include "TestFixture.hpp"
+
+TEST_F(VarsSetupFixture, NaryApply_SameAsPairwise)
+{
+  using namespace bddHelper;
+  // Values of objects that are far from each other in order
+  std::vector< bdd > operands;
+  for (auto objNum : std::views::iota(0, nObjs))
+    operands.push_back(h.getObjectVal(static_cast< Object >(objNum), Property::COLOR, objNum) |
+                       h.getObjectVal(static_cast< Object >(nObjs - 1 - objNum), Property::PLANT, objNum));
+  operands.push_back(operands.front());
+  EXPECT_EQ(naryApply::conjunction(operands),
+            std::accumulate(operands.begin(), operands.end(), bdd_true(), std::bit_and< bdd >()));
+  EXPECT_EQ(naryApply::disjunction(operands),
+            std::accumulate(operands.begin(), operands.end(), bdd_false(), std::bit_or< bdd >()));
+
+  EXPECT_EQ(naryApply::conjunction({}), bdd_true());
+  EXPECT_EQ(naryApply::disjunction({}), bdd_false());
+  EXPECT_EQ(naryApply::conjunction({ v[0][0][0], bdd_false() }), bdd_false());
+  EXPECT_EQ(naryApply::disjunction({ v[0][0][0], bdd_true() }), bdd_true());
+  EXPECT_EQ(naryApply::disjunction({ v[0][0][0], bdd_false() }), v[0][0][0]);
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef NARY_APPLY_HPP
+#define NARY_APPLY_HPP
+
+#include <vector>
+#include "bdd.h"
+
+/**
+ * AND / OR of many formulas, joined as a balanced tree of BuDDy applies.
+ *
+ * a | b | c | ... joined one by one builds a new formula for each step,
+ * and each of them has all the operands before it. All but the last
+ * are thrown away. Here operands are joined in pairs, then pairs of
+ * pairs and so on, so formulas in the middle are small parts of the
+ * result. Constants and repeated operands are dropped first.
+ */
+namespace naryApply
+{
+  // See NaryApply.cpp file
+  bdd conjunction(std::vector< bdd > operands);
+
+  // See NaryApply.cpp file
+  bdd disjunction(std::vector< bdd > operands);
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "NodeTable.hpp"
+#include <unordered_map>
+#include <algorithm>
+#include <ranges>
+#include <cmath>
+
+namespace nodeTable
+{
+  // Level of node in current variables order.
+  // Constants (true and false) are placed below the last level.
+  int nodeLevel(int node)
+  {
+    if (node < 2)
+      return bdd_varnum();
+    return bdd_var2level(bdd_var(node));
+  }
+
+  /**
+   * Cube is formula like a & !b & !c & d, as bdd_fullsatone or
+   * value of object property gives. Its only path to true is walked
+   * from root and each variable is written with the branch taken.
+   */
+  std::vector< Literal > cubeLiterals(const bdd &cube)
+  {
+    std::vector< Literal > literals;
+    auto node = cube.id();
+    while (node >= 2)
+    {
+      auto toHigh = bdd_low(node) == 0;
+      literals.push_back({ bdd_var(node), toHigh ? 1 : 0 });
+      node = toHigh ? bdd_high(node) : bdd_low(node);
+    }
+    return literals;
+  }
+
+  int NodeTable::size() const
+  {
+    return static_cast< int >(levels.size());
+  }
+
+  /**
+   * All nodes of formula sorted by level, both constants included.
+   * BuDDy is asked about each node once, here.
+   */
+  NodeTable collectNodes(const bdd &formula)
+  {
+    // Find all nodes with our own stack. No recursion, any depth is fine.
+    std::unordered_map< int, int > index;
+    std::vector< std::pair< int, int > > byLevel;
+    std::vector< int > stack = { formula.id(), 0, 1 };
+    while (not stack.empty())
+    {
+      auto node = stack.back();
+      stack.pop_back();
+      if (not index.emplace(node, 0).second)
+        continue;
+      byLevel.emplace_back(nodeLevel(node), node);
+      if (node >= 2)
+      {
+        stack.push_back(bdd_low(node));
+        stack.push_back(bdd_high(node));
+      }
+    }
+    std::ranges::sort(byLevel);
+    NodeTable table;
+    table.levels.reserve(byLevel.size());
+    table.ids.reserve(byLevel.size());
+    for (auto [level, node] : byLevel)
+    {
+      index[node] = table.size();
+      table.ids.push_back(node);
+      table.levels.push_back(level);
+    }
+    table.lows.resize(table.ids.size(), -1);
+    table.highs.resize(table.ids.size(), -1);
+    for (auto i : std::views::iota(0, table.size()))
+    {
+      if (table.ids[i] < 2)
+        continue;
+      table.lows[i] = index[bdd_low(table.ids[i])];
+      table.highs[i] = index[bdd_high(table.ids[i])];
+    }
+    table.root = index[formula.id()];
+    table.falseNode = index[0];
+    table.trueNode = index[1];
+    return table;
+  }
+
+  /**
+   * Bottom-up: result[i] is count of combinations of levels from
+   * level of node i to the last one, that lead from node i to true.
+   */
+  std::vector< double > satCounts(const NodeTable &table)
+  {
+    std::vector< double > sat(table.size(), 0);
+    sat[table.trueNode] = 1;
+    for (auto i : std::views::iota(0, table.size()) | std::views::reverse)
+    {
+      auto low = table.lows[i];
+      auto high = table.highs[i];
+      if (low < 0)
+        continue;
+      sat[i] = std::ldexp(sat[low], table.levels[low] - table.levels[i] - 1) +
+               std::ldexp(sat[high], table.levels[high] - table.levels[i] - 1);
+    }
+    return sat;
+  }
+
+  // Same as bdd_satcount
+  double satCount(const NodeTable &table)
+  {
+    return std::ldexp(satCounts(table)[table.root], table.levels[table.root]);
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include "TestFixture.hpp"
+
+TEST_F(VarsSetupFixture, NodeTable_Collect)
+{
+  using namespace bddHelper;
+  auto formula = (h.getObjectVal(Object::FIRST, Color::RED) | h.getObjectVal(Object::SECOND, Color::RED)) &
+                 not h.getObjectVal(Object::NINETH, Animal::CAT);
+  auto table = nodeTable::collectNodes(formula);
+  EXPECT_EQ(table.size(), bdd_nodecount(formula) + 2);
+  EXPECT_EQ(table.ids[table.root], formula.id());
+  EXPECT_EQ(table.ids[table.falseNode], 0);
+  EXPECT_EQ(table.ids[table.trueNode], 1);
+  for (auto i : std::views::iota(0, table.size()))
+  {
+    if (table.lows[i] < 0)
+      continue;
+    // Children are below parents
+    EXPECT_GT(table.levels[table.lows[i]], table.levels[i]);
+    EXPECT_GT(table.levels[table.highs[i]], table.levels[i]);
+    EXPECT_EQ(table.ids[table.lows[i]], bdd_low(table.ids[i]));
+  }
+  EXPECT_DOUBLE_EQ(nodeTable::satCount(table), bdd_satcount(formula));
+  EXPECT_EQ(nodeTable::satCount(nodeTable::collectNodes(bdd_false())), 0);
+  EXPECT_DOUBLE_EQ(nodeTable::satCount(nodeTable::collectNodes(bdd_true())), bdd_satcount(bdd_true()));
+}
+
+TEST_F(VarsSetupFixture, NodeTable_CubeLiterals)
+{
+  using namespace bddHelper;
+  // Value 5 is 0101
+  auto literals = nodeTable::cubeLiterals(h.numToBin(5, v[1][2]));
+  ASSERT_EQ(literals.size(), 4u);
+  for (auto bit : std::views::iota(0, nValueBits))
+  {
+    EXPECT_EQ(literals[bit].var, bdd_var(v[1][2][bit]));
+    EXPECT_EQ(literals[bit].value, bit % 2);
+  }
+  EXPECT_TRUE(nodeTable::cubeLiterals(bdd_true()).empty());
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef NODE_TABLE_HPP
+#define NODE_TABLE_HPP
+
+#include <vector>
+#include "bdd.h"
+
+/**
+ * Copy of formula nodes for walking them many times.
+ *
+ * BuDDy keeps node as one 24 bytes record: reference counter, level,
+ * low, high and two fields of its hash table. Walks like counting
+ * need only level, low and high, but read whole records, and each
+ * bdd_var / bdd_low / bdd_high call is a function call that checks
+ * its argument. Here nodes are numbered from 0 in level order and
+ * fields are kept in separate arrays (structure of arrays): walks read
+ * 12 bytes per node from three contiguous arrays. BuDDy node numbers
+ * are kept apart, only to get back to BuDDy.
+ */
+namespace nodeTable
+{
+  struct NodeTable
+  {
+    // Fields of node i. Parents always go before children.
+    // Constants are at the end, their level is bdd_varnum(), children are -1.
+    std::vector< int > levels;
+    std::vector< int > lows;
+    std::vector< int > highs;
+    // BuDDy node number of node i
+    std::vector< int > ids;
+    int root = -1;
+    // Constants, so walks don't have to look at ids
+    int falseNode = -1;
+    int trueNode = -1;
+
+    int size() const;
+  };
+
+  // See NodeTable.cpp file
+  int nodeLevel(int node);
+
+  // Variable of cube and its value, 0 or 1
+  struct Literal
+  {
+    int var;
+    int value;
+  };
+
+  // See NodeTable.cpp file
+  std::vector< Literal > cubeLiterals(const bdd &cube);
+
+  // See NodeTable.cpp file
+  NodeTable collectNodes(const bdd &formula);
+
+  // See NodeTable.cpp file
+  std::vector< double > satCounts(const NodeTable &table);
+
+  // See NodeTable.cpp file
+  double satCount(const NodeTable &table);
+}
+
+#endif
@@ -0,0 +1,341 @@
+#include "OrderSearch.hpp"
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <ranges>
+#include <algorithm>
+
+namespace
+{
+  using orderSearch::Candidate;
+  using orderSearch::GroupOrder;
+
+  // Evaluates order with node limit and reports it
+  using TryOrder = std::function< Candidate(const GroupOrder &order, int nodeLimit) >;
+
+  // Less nodes is better. Aborted order is worse than any finished one.
+  bool isBetter(const Candidate &a, const Candidate &b)
+  {
+    if (a.aborted != b.aborted)
+      return b.aborted;
+    return not a.aborted and a.peakLiveNodes < b.peakLiveNodes;
+  }
+
+  /**
+   * Take each group out and put it where order is the best.
+   * Like BuDDy sifting, but for whole groups and with real joining
+   * as the cost, not just size of existing nodes.
+   */
+  Candidate sift(Candidate current, int nodeLimit, const TryOrder &tryOrder)
+  {
+    for (auto group : GroupOrder(current.order))
+    {
+      auto without = current.order;
+      std::erase(without, group);
+      for (auto pos : std::views::iota(std::size_t(0), without.size() + 1))
+      {
+        auto order = without;
+        order.insert(order.begin() + pos, group);
+        if (order == current.order)
+          continue;
+        // Only better orders matter, so don't finish worse ones
+        auto candidate = tryOrder(order, current.aborted ? nodeLimit : current.peakLiveNodes);
+        if (isBetter(candidate, current))
+          current = std::move(candidate);
+      }
+    }
+    return current;
+  }
+
+  /**
+   * Swap two random groups. Better order is always kept, worse one is kept
+   * with probability exp(-growth / temperature), where growth is relative.
+   * Temperature goes down to zero, so at the end only better orders are kept.
+   * It lets us get out of local minimum where sifting stops.
+   */
+  Candidate anneal(Candidate current, int steps, int nodeLimit, std::mt19937 &random, const TryOrder &tryOrder)
+  {
+    constexpr double startTemperature = 0.1;
+    auto best = current;
+    std::uniform_int_distribution< std::size_t > pick(0, current.order.size() - 1);
+    std::uniform_real_distribution< double > chance(0, 1);
+    for (auto step : std::views::iota(0, steps))
+    {
+      auto temperature = startTemperature * (steps - step) / steps;
+      auto order = current.order;
+      auto i = pick(random);
+      auto j = pick(random);
+      if (i == j)
+        continue;
+      std::swap(order[i], order[j]);
+      // Twice worse order is never kept anyway
+      auto limit = current.aborted ? nodeLimit : std::min(nodeLimit, current.peakLiveNodes * 2);
+      auto candidate = tryOrder(order, limit);
+      if (candidate.aborted)
+        continue;
+      auto growth = current.aborted ? 0 :
+        static_cast< double >(candidate.peakLiveNodes - current.peakLiveNodes) / current.peakLiveNodes;
+      if (isBetter(candidate, current) or chance(random) < std::exp(-growth / temperature))
+        current = std::move(candidate);
+      if (isBetter(current, best))
+        best = current;
+    }
+    return best;
+  }
+}
+
+namespace orderSearch
+{
+  void writeOrder(std::ostream &out, const GroupOrder &order)
+  {
+    for (auto [obj, prop] : order)
+      out << bddHelper::toNum(obj) << ' ' << bddHelper::toNum(prop) << '\n';
+  }
+
+  std::optional< GroupOrder > readOrder(std::istream &in)
+  {
+    GroupOrder order;
+    std::vector< char > seen(BDDHelper::nObjs * BDDHelper::nProps, 0);
+    int objNum, propNum;
+    while (in >> objNum >> propNum)
+    {
+      if (objNum < 0 or objNum >= BDDHelper::nObjs or propNum < 0 or propNum >= BDDHelper::nProps)
+        return std::nullopt;
+      auto &isSeen = seen[objNum * BDDHelper::nProps + propNum];
+      if (isSeen)
+        return std::nullopt;
+      isSeen = 1;
+      order.emplace_back(static_cast< bddHelper::Object >(objNum), static_cast< bddHelper::Property >(propNum));
+    }
+    if (not in.eof() or order.size() != seen.size())
+      return std::nullopt;
+    return order;
+  }
+
+  Candidate evaluate(BDDHelper &h, const std::vector< bdd > &conditions,
+                     const GroupOrder &order, int nodeLimit)
+  {
+    Candidate res;
+    res.order = order;
+    h.setGroupOrder(order);
+    auto start = std::chrono::steady_clock::now();
+    // Joined formula is formulas[0], joined conditions are replaced with
+    // bdd_true(), so live nodes are counted as BDDFormulaBuilder counts them
+    std::vector< bdd > formulas;
+    formulas.reserve(conditions.size() + 1);
+    formulas.push_back(bdd_true());
+    formulas.insert(formulas.end(), conditions.begin(), conditions.end());
+    for (auto i : std::views::iota(std::size_t(0), formulas.size()))
+    {
+      if (i > 0)
+      {
+        formulas[0] &= formulas[i];
+        formulas[i] = bdd_true();
+      }
+      auto nodes = bdd_anodecount(formulas.data(), static_cast< int >(formulas.size()));
+      res.peakLiveNodes = std::max(res.peakLiveNodes, nodes);
+      if (nodes > nodeLimit)
+      {
+        res.aborted = true;
+        break;
+      }
+    }
+    res.seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+    return res;
+  }
+
+  GroupOrder forceOrder(BDDHelper &h, const std::vector< bdd > &conditions, int maxIterations)
+  {
+    constexpr int nGroups = BDDHelper::nObjs * BDDHelper::nProps;
+    auto groupNum = [](const BDDHelper::Group &group) {
+      return bddHelper::toNum(group.first) * BDDHelper::nProps + bddHelper::toNum(group.second);
+    };
+    auto groups = h.getGroupOrder();
+    std::vector< int > groupOfVar(bdd_varnum(), -1);
+    for (auto &group : groups)
+      for (auto bit : std::views::iota(0, h.nGroupVars()))
+        groupOfVar[h.getVarNum(group.first, group.second, bit)] = groupNum(group);
+
+    // Groups of each condition. Conditions of one group don't affect order.
+    // Variables that are not in groups (dual model) are skipped.
+    std::vector< std::vector< int > > edges;
+    for (auto &condition : conditions)
+    {
+      std::vector< int > edge;
+      for (auto node = bdd_support(condition); node != bdd_true(); node = bdd_high(node))
+        if (auto group = groupOfVar[bdd_var(node)]; group >= 0)
+          edge.push_back(group);
+      std::ranges::sort(edge);
+      auto [last, end] = std::ranges::unique(edge);
+      edge.erase(last, end);
+      if (edge.size() > 1)
+        edges.push_back(std::move(edge));
+    }
+
+    // pos[g] is place of group g in order
+    std::vector< double > pos(nGroups);
+    for (auto i : std::views::iota(0, nGroups))
+      pos[groupNum(groups[i])] = i;
+    auto span = [&edges, &pos]() {
+      double total = 0;
+      for (auto &edge : edges)
+      {
+        auto [lo, hi] = std::ranges::minmax(edge | std::views::transform([&pos](int g) { return pos[g]; }));
+        total += hi - lo;
+      }
+      return total;
+    };
+    auto bestOrder = groups;
+    auto bestSpan = span();
+    for (auto iteration : std::views::iota(0, maxIterations))
+    {
+      (void)iteration;
+      std::vector< double > sum(nGroups, 0);
+      std::vector< int > count(nGroups, 0);
+      for (auto &edge : edges)
+      {
+        double center = 0;
+        for (auto g : edge)
+          center += pos[g];
+        center /= edge.size();
+        for (auto g : edge)
+        {
+          sum[g] += center;
+          ++count[g];
+        }
+      }
+      // Sort by new place, old place decides for equal ones
+      std::vector< std::pair< double, double > > newPos(nGroups);
+      for (auto g : std::views::iota(0, nGroups))
+        newPos[g] = { count[g] ? sum[g] / count[g] : pos[g], pos[g] };
+      std::ranges::sort(groups, {}, [&](const BDDHelper::Group &group) { return newPos[groupNum(group)]; });
+      for (auto i : std::views::iota(0, nGroups))
+        pos[groupNum(groups[i])] = i;
+      auto newSpan = span();
+      if (newSpan >= bestSpan)
+        break;
+      bestSpan = newSpan;
+      bestOrder = groups;
+    }
+    return bestOrder;
+  }
+
+  Candidate search(BDDHelper &h, const std::vector< bdd > &conditions, const SearchOptions &options)
+  {
+    auto initial = h.getGroupOrder();
+    std::mt19937 random(options.seed);
+    TryOrder tryOrder = [&](const GroupOrder &order, int nodeLimit) {
+      auto candidate = evaluate(h, conditions, order, nodeLimit);
+      if (options.report)
+        options.report(candidate);
+      return candidate;
+    };
+    auto best = tryOrder(initial, options.nodeLimit);
+    for (auto restart : std::views::iota(0, options.restarts + 1))
+    {
+      auto current = best;
+      if (restart > 0)
+      {
+        auto order = initial;
+        std::ranges::shuffle(order, random);
+        current = tryOrder(order, options.nodeLimit);
+      }
+      current = sift(std::move(current), options.nodeLimit, tryOrder);
+      current = anneal(std::move(current), options.annealSteps, options.nodeLimit, random, tryOrder);
+      if (isBetter(current, best))
+        best = std::move(current);
+    }
+    h.setGroupOrder(initial);
+    return best;
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include <sstream>
+#include "BDDFormulaBuilder.hpp"
+#include "TestFixture.hpp"
+
+TEST_F(VarsSetupFixture, OrderSearch_File)
+{
+  using namespace bddHelper;
+  auto order = h.getGroupOrder();
+  std::ranges::reverse(order);
+  std::stringstream file;
+  orderSearch::writeOrder(file, order);
+  EXPECT_EQ(orderSearch::readOrder(file), order);
+
+  // Group given twice
+  std::stringstream twice;
+  orderSearch::writeOrder(twice, order);
+  twice << "0 0\n";
+  EXPECT_FALSE(orderSearch::readOrder(twice).has_value());
+  // Not a number
+  std::stringstream bad("0 0\n0 x\n");
+  EXPECT_FALSE(orderSearch::readOrder(bad).has_value());
+  // Too short
+  std::stringstream shortFile("0 0\n0 1\n");
+  EXPECT_FALSE(orderSearch::readOrder(shortFile).has_value());
+}
+
+TEST_F(VarsSetupFixture, OrderSearch_Force)
+{
+  using namespace bddHelper;
+  // Colors of FIRST and SIXTH, SECOND and SEVENTH... are linked.
+  // In current order all four pairs are crossed, so formula is big.
+  std::vector< bdd > conditions;
+  for (auto objNum : std::views::iota(0, 4))
+    conditions.push_back(bdd_biimp(v[objNum][0][0], v[objNum + 5][0][0]) &
+                         bdd_biimp(v[objNum][0][1], v[objNum + 5][0][1]));
+  auto initial = h.getGroupOrder();
+  auto order = orderSearch::forceOrder(h, conditions);
+  // Only order is computed, nothing is set
+  EXPECT_EQ(h.getGroupOrder(), initial);
+  auto place = [&order](Object obj) {
+    return std::ranges::find(order, BDDHelper::Group(obj, Property::COLOR)) - order.begin();
+  };
+  EXPECT_LE(std::abs(place(Object::FIRST) - place(Object::SIXTH)), 2);
+  EXPECT_LE(std::abs(place(Object::FOURTH) - place(Object::NINETH)), 2);
+  auto before = orderSearch::evaluate(h, conditions, initial, 1000000);
+  auto after = orderSearch::evaluate(h, conditions, order, 1000000);
+  EXPECT_LT(after.peakLiveNodes, before.peakLiveNodes);
+  // Other tests expect variable number to be its level
+  h.setGroupOrder(initial);
+}
+
+TEST_F(VarsSetupFixture, OrderSearch_Search)
+{
+  using namespace bddHelper;
+  // Each object color is equal to color of object far from it.
+  // When these objects are far in order too, formula is big.
+  std::vector< bdd > conditions;
+  for (auto objNum : std::views::iota(0, 4))
+    conditions.push_back(bdd_biimp(v[objNum][0][0], v[nObjs - 1 - objNum][0][0]) &
+                         bdd_biimp(v[objNum][0][1], v[nObjs - 1 - objNum][0][1]));
+  auto initial = h.getGroupOrder();
+  int nReported = 0;
+  orderSearch::SearchOptions options;
+  options.restarts = 0;
+  options.annealSteps = 20;
+  options.report = [&](const orderSearch::Candidate &) { ++nReported; };
+  auto first = orderSearch::evaluate(h, conditions, initial, options.nodeLimit);
+  auto best = orderSearch::search(h, conditions, options);
+  // Search sets initial order back
+  EXPECT_EQ(h.getGroupOrder(), initial);
+  EXPECT_FALSE(best.aborted);
+  EXPECT_LT(best.peakLiveNodes, first.peakLiveNodes);
+  EXPECT_GT(nReported, nObjs * nProps);
+  EXPECT_EQ(orderSearch::evaluate(h, conditions, best.order, options.nodeLimit).peakLiveNodes, best.peakLiveNodes);
+  // Peak is the same that BDDFormulaBuilder reports
+  h.setGroupOrder(best.order);
+  BDDFormulaBuilder builder;
+  builder.setTrackPeak(true);
+  for (auto &condition : conditions)
+    builder.addCondition(condition);
+  builder.result();
+  EXPECT_EQ(builder.stats().peakLiveNodes, best.peakLiveNodes);
+  // Other tests expect variable number to be its level
+  h.setGroupOrder(initial);
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef ORDER_SEARCH_HPP
+#define ORDER_SEARCH_HPP
+
+#include <vector>
+#include <optional>
+#include <istream>
+#include <ostream>
+#include <functional>
+#include "bdd.h"
+#include "BDDHelper.hpp"
+
+/**
+ * Here we look for variables order that makes conditions
+ * formula cheap to build.
+ *
+ * Order is searched offline by bdd_order_search tool (see mainOrderSearch.cpp)
+ * and saved to file. bdd_main loads it with --order-file, so we don't
+ * pay for reordering on every run.
+ *
+ * Bits of one object property always stay together,
+ * so we search order of these groups only.
+ */
+namespace orderSearch
+{
+  using bddHelper::BDDHelper;
+  using GroupOrder = std::vector< BDDHelper::Group >;
+
+  /**
+   * Write order as lines "objNum propNum", one group per line,
+   * from the first level to the last.
+   */
+  void writeOrder(std::ostream &out, const GroupOrder &order);
+
+  /**
+   * Read order written by writeOrder.
+   * Return nothing if something is wrong: bad numbers,
+   * some object property is missing or given twice.
+   */
+  std::optional< GroupOrder > readOrder(std::istream &in);
+
+  // Cost of one tried order
+  struct Candidate
+  {
+    GroupOrder order;
+    /**
+     * Max nodes of joined formula and conditions that wait to be joined.
+     * Same as BDDFormulaBuilder::Stats::peakLiveNodes that bdd_main --peak
+     * prints: order that is better for joined formula only can need
+     * more nodes for all of them.
+     */
+    int peakLiveNodes = 0;
+    double seconds = 0;   // Time spent to join them
+    bool aborted = false; // Nodes got more than limit, peakLiveNodes is not known
+  };
+
+  /**
+   * Set order and join conditions one by one as BDDFormulaBuilder does.
+   * If formulas get more than nodeLimit live nodes we stop - this order
+   * is worse than one we already have anyway.
+   */
+  Candidate evaluate(BDDHelper &h, const std::vector< bdd > &conditions,
+                     const GroupOrder &order, int nodeLimit);
+
+  struct SearchOptions
+  {
+    int restarts = 1;        // Random orders to start from besides the current one
+    int annealSteps = 200;   // Steps of simulated annealing after each sifting
+    unsigned seed = 1;       // Seed for random orders and annealing
+    int nodeLimit = 1000000; // Orders with more live nodes are not finished
+    // Called for every tried order
+    std::function< void(const Candidate &) > report;
+  };
+
+  /**
+   * Quick order without joining anything (FORCE heuristic).
+   * Each condition links object properties it has variables of,
+   * for example neighbours condition links colors of two objects.
+   * Linked groups should be close to each other in order.
+   * We start from current order and move each group to the average
+   * of centers of conditions it's in, then sort groups by new places.
+   * It's repeated while total span of conditions gets smaller.
+   * Takes milliseconds, so it can be done on every run.
+   */
+  GroupOrder forceOrder(BDDHelper &h, const std::vector< bdd > &conditions, int maxIterations = 50);
+
+  /**
+   * Find order with least peak live nodes.
+   * We start from current order and then from options.restarts random ones.
+   * From each start we sift: move each group to the position where it's
+   * the best. Then we anneal: swap two random groups, keep the swap if it's better,
+   * sometimes keep it even if it's worse, less and less often.
+   * Order that was set when we were called is set back at the end.
+   */
+  Candidate search(BDDHelper &h, const std::vector< bdd > &conditions, const SearchOptions &options);
+}
+
+#endif
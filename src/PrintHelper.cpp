@@ -108,3 +108,17 @@ std::string to_string(bddHelper::Animal animal)
   assert(("Bad enum value", false));
   std::unreachable();
 }
+
+std::string to_string(bddHelper::Property prop, int valNum)
+{
+  using namespace bddHelper;
+  switch (prop)
+  {
+    case Property::ANIMAL:   return to_string(static_cast< Animal >(valNum));
+    case Property::NATION:   return to_string(static_cast< Nation >(valNum));
+    case Property::COLOR:    return to_string(static_cast< Color >(valNum));
+    case Property::PLANT:    return to_string(static_cast< Plant >(valNum));
+  }
+  assert(("Bad enum value", false));
+  std::unreachable();
+}
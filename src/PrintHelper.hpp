@@ -9,5 +9,7 @@ std::string to_string(bddHelper::Color col);
 std::string to_string(bddHelper::Nation col);
 std::string to_string(bddHelper::Plant col);
 std::string to_string(bddHelper::Animal col);
+// Name of property prop value with number valNum
+std::string to_string(bddHelper::Property prop, int valNum);
 
 #endif
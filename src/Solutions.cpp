@@ -0,0 +1,378 @@
+#include "Solutions.hpp"
+#include "NodeTable.hpp"
+#include <ranges>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <system_error>
+#include <cassert>
+
+namespace solutions
+{
+  SolutionRange::SolutionRange(const bdd &formula, std::size_t limit) :
+    formula_(formula),
+    nLevels_(bdd_varnum()),
+    nFixedLevels_(0),
+    current_(nLevels_, 0),
+    limit_(limit),
+    produced_(0),
+    started_(false),
+    finished_(false),
+    delivered_(false)
+  {
+    // One frame per level and one for the true node at the bottom.
+    // Reserved once, so walking never allocates.
+    stack_.reserve(nLevels_ + 1);
+  }
+
+  /**
+   * Here we walk down the fixed levels right away and remember
+   * where we came. next() never goes back above nFixedLevels_,
+   * so we get only combinations of this cofactor.
+   */
+  SolutionRange::SolutionRange(const bdd &formula, int nFixedLevels, unsigned fixedValues,
+                               std::size_t limit) :
+    SolutionRange(formula, limit)
+  {
+    assert(nFixedLevels >= 0 and nFixedLevels <= nLevels_);
+    nFixedLevels_ = nFixedLevels;
+    auto node = formula_.id();
+    for (auto level : std::views::iota(0, nFixedLevels_))
+    {
+      int branch = (fixedValues >> (nFixedLevels_ - 1 - level)) & 1;
+      stack_.push_back({ node, branch });
+      current_[bdd_level2var(level)] = branch;
+      node = child(node, level, branch);
+    }
+    // Whole cofactor is false - nothing to walk
+    if (node == 0)
+    {
+      started_ = true;
+      finished_ = true;
+    }
+  }
+
+  SolutionRange::Iterator SolutionRange::begin()
+  {
+    resume();
+    return Iterator(this);
+  }
+
+  /**
+   * First begin() finds the first combination. Next calls continue
+   * from the current one, unless it was already given: loop stopped
+   * with break after dereference and before increment.
+   * std::views::take increments after the last element it gives,
+   * so then the current one is new.
+   */
+  void SolutionRange::resume()
+  {
+    if (not started_)
+    {
+      started_ = true;
+      next();
+    }
+    else if (delivered_)
+      next();
+    delivered_ = false;
+  }
+
+  std::default_sentinel_t SolutionRange::end() const
+  {
+    return std::default_sentinel;
+  }
+
+  std::size_t SolutionRange::produced() const
+  {
+    return produced_;
+  }
+
+  // Where we go from node if variable at level has value branch.
+  // If node is below the level - variable can be anything, so we stay at node.
+  int SolutionRange::child(int node, int level, int branch) const
+  {
+    if (nodeTable::nodeLevel(node) != level)
+      return node;
+    return branch == 0 ? bdd_low(node) : bdd_high(node);
+  }
+
+  /**
+   * Go down from the top frame to the true node choosing 0 where we can.
+   * Each node except false has at least one path to true,
+   * so we never have to go back here.
+   */
+  void SolutionRange::descend()
+  {
+    while (static_cast< int >(stack_.size()) <= nLevels_)
+    {
+      auto level = static_cast< int >(stack_.size()) - 1;
+      auto &frame = stack_.back();
+      auto low = child(frame.node, level, 0);
+      frame.branch = low != 0 ? 0 : 1;
+      current_[bdd_level2var(level)] = frame.branch;
+      auto next = frame.branch == 0 ? low : child(frame.node, level, 1);
+      stack_.push_back({ next, 0 });
+    }
+  }
+
+  /**
+   * Find next combination. It's the same depth first search
+   * as recursive one, but the recursion is in stack_.
+   * We go up until we find level where we chose 0 and 1 is also possible,
+   * choose 1 there and go down again.
+   */
+  bool SolutionRange::next()
+  {
+    if (finished_)
+      return false;
+    if (produced_ >= limit_)
+    {
+      finished_ = true;
+      return false;
+    }
+    if (produced_ == 0)
+    {
+      if (formula_ == bdd_false())
+      {
+        finished_ = true;
+        return false;
+      }
+      // Node below the fixed levels
+      auto node = stack_.empty() ? formula_.id() : child(stack_.back().node, nFixedLevels_ - 1, stack_.back().branch);
+      stack_.push_back({ node, 0 });
+      descend();
+      ++produced_;
+      return true;
+    }
+    // Remove true node
+    stack_.pop_back();
+    while (static_cast< int >(stack_.size()) > nFixedLevels_)
+    {
+      auto level = static_cast< int >(stack_.size()) - 1;
+      auto &frame = stack_.back();
+      if (frame.branch == 0)
+      {
+        auto high = child(frame.node, level, 1);
+        if (high != 0)
+        {
+          frame.branch = 1;
+          current_[bdd_level2var(level)] = 1;
+          stack_.push_back({ high, 0 });
+          descend();
+          ++produced_;
+          return true;
+        }
+      }
+      current_[bdd_level2var(level)] = 0;
+      stack_.pop_back();
+    }
+    finished_ = true;
+    return false;
+  }
+
+  SolutionRange::Iterator::Iterator(SolutionRange *range) :
+    range_(range)
+  {}
+
+  const VarSet &SolutionRange::Iterator::operator*() const
+  {
+    range_->delivered_ = true;
+    return range_->current_;
+  }
+
+  SolutionRange::Iterator &SolutionRange::Iterator::operator++()
+  {
+    range_->next();
+    range_->delivered_ = false;
+    return *this;
+  }
+
+  void SolutionRange::Iterator::operator++(int)
+  {
+    ++*this;
+  }
+
+  bool SolutionRange::Iterator::operator==(std::default_sentinel_t) const
+  {
+    return range_->finished_;
+  }
+
+  /**
+   * bdd_fullsatone gives us formula like
+   * a & !b & !c & d & ...
+   * that contains ALL the variables. We just walk it down
+   * and write variables values into varset.
+   */
+  std::optional< VarSet > findOne(const bdd &formula)
+  {
+    if (formula == bdd_false())
+      return std::nullopt;
+    VarSet varset(bdd_varnum(), 0);
+    for (auto [var, value] : nodeTable::cubeLiterals(bdd_fullsatone(formula)))
+      varset[var] = static_cast< char >(value);
+    return varset;
+  }
+
+  std::vector< VarSet > findUpTo(const bdd &formula, std::size_t k)
+  {
+    std::vector< VarSet > result;
+    for (auto &varset : SolutionRange(formula, k))
+      result.push_back(varset);
+    return result;
+  }
+
+  void enumerateSharded(const bdd &formula, int splitLevels,
+                        const std::vector< std::ostream * > &shards, const ShardWriter &write)
+  {
+    assert(shards.size() == (1u << splitLevels));
+    // Ranges are created here, not in threads,
+    // because copying bdd changes reference counters.
+    std::vector< SolutionRange > ranges;
+    ranges.reserve(shards.size());
+    for (auto shardNum : std::views::iota(0u, static_cast< unsigned >(shards.size())))
+      ranges.emplace_back(formula, splitLevels, shardNum);
+    // Parts are many (up to 2^16), threads are few. Each thread
+    // takes next part number until all parts are taken.
+    std::atomic< unsigned > nextShard = 0;
+    auto work = [&]() {
+      for (auto shardNum = nextShard++; shardNum < shards.size(); shardNum = nextShard++)
+      {
+        for (auto &varset : ranges[shardNum])
+          write(*shards[shardNum], varset);
+      }
+    };
+    auto nWorkers = std::min(std::max(std::thread::hardware_concurrency(), 1u), static_cast< unsigned >(shards.size()));
+    std::vector< std::jthread > threads;
+    // This thread is a worker too, so parts are walked even if no thread can be created
+    for (auto workerNum = 1u; workerNum < nWorkers; ++workerNum)
+    {
+      try
+      {
+        threads.emplace_back(work);
+      }
+      catch (const std::system_error &)
+      {
+        break;
+      }
+    }
+    work();
+    // jthread joins in destructor. Threads are destroyed before ranges.
+  }
+}
+
+#ifdef GTEST_TESTING
+#include <gtest/gtest.h>
+#include <set>
+#include <sstream>
+#include "TestFixture.hpp"
+
+namespace
+{
+  // Convert combination back to formula. Used to check it satisfies conditions.
+  bdd toCube(const solutions::VarSet &varset)
+  {
+    auto cube = bdd_true();
+    for (auto var : std::views::iota(0, static_cast< int >(varset.size())))
+      cube &= varset[var] ? bdd_ithvar(var) : bdd_nithvar(var);
+    return cube;
+  }
+}
+
+TEST_F(VarsSetupFixture, Solutions_FindOne)
+{
+  using namespace bddHelper;
+  auto formula = h.getObjectVal(Object::FIRST, Color::RED) & h.getObjectVal(Object::SECOND, Nation::CHINA);
+  auto res = solutions::findOne(formula);
+  ASSERT_TRUE(res.has_value());
+  EXPECT_EQ(res->size(), nTotalVars);
+  EXPECT_NE(toCube(*res) & formula, bdd_false());
+  EXPECT_FALSE(solutions::findOne(bdd_false()).has_value());
+}
+
+TEST_F(VarsSetupFixture, Solutions_Range)
+{
+  using namespace bddHelper;
+  // Fix all but 3 last variables - 8 combinations
+  auto formula = bdd_true();
+  for (auto var : std::views::iota(0, nTotalVars - 3))
+    formula &= var % 2 ? bdd_ithvar(var) : bdd_nithvar(var);
+  std::set< solutions::VarSet > all;
+  for (auto &varset : solutions::SolutionRange(formula))
+  {
+    EXPECT_NE(toCube(varset) & formula, bdd_false());
+    all.insert(varset);
+  }
+  EXPECT_EQ(all.size(), 8);
+
+  // Limit
+  solutions::SolutionRange limited(formula, 5);
+  EXPECT_EQ(std::ranges::distance(limited), 5);
+
+  // Stop and resume: the same sequence, each combination once
+  std::vector< solutions::VarSet > sequence;
+  for (auto &varset : solutions::SolutionRange(formula))
+    sequence.push_back(varset);
+  solutions::SolutionRange range(formula);
+  std::vector< solutions::VarSet > resumed;
+  for (auto &varset : range | std::views::take(3))
+    resumed.push_back(varset);
+  EXPECT_EQ(resumed.size(), 3);
+  for (auto &varset : range)
+  {
+    resumed.push_back(varset);
+    if (resumed.size() == 5)
+      break;
+  }
+  for (auto &varset : range)
+    resumed.push_back(varset);
+  EXPECT_EQ(resumed, sequence);
+  EXPECT_DOUBLE_EQ(static_cast< double >(resumed.size()), bdd_satcount(formula));
+  EXPECT_EQ(range.produced(), 8);
+}
+
+TEST_F(VarsSetupFixture, Solutions_Sharded)
+{
+  using namespace bddHelper;
+  auto formula = bdd_true();
+  for (auto var : std::views::iota(3, nTotalVars - 3))
+    formula &= var % 2 ? bdd_ithvar(var) : bdd_nithvar(var);
+  formula &= not (bdd_ithvar(0) & bdd_ithvar(1));
+  auto write = [](std::ostream &out, const solutions::VarSet &varset) {
+    out << varset;
+  };
+  std::ostringstream sequential;
+  for (auto &varset : solutions::SolutionRange(formula))
+    write(sequential, varset);
+
+  std::vector< std::ostringstream > shards(4);
+  std::vector< std::ostream * > shardPtrs;
+  for (auto &shard : shards)
+    shardPtrs.push_back(&shard);
+  solutions::enumerateSharded(formula, 2, shardPtrs, write);
+  std::string joined;
+  for (auto &shard : shards)
+    joined += shard.str();
+  // 3 of 4 cofactors on first two vars, 2 * 2^3 combinations in each
+  EXPECT_EQ(joined.size(), 3 * 16 * nTotalVars);
+  EXPECT_TRUE(shards[3].str().empty());
+  EXPECT_EQ(joined, sequential.str());
+}
+
+TEST_F(VarsSetupFixture, Solutions_FindUpTo)
+{
+  using namespace bddHelper;
+  auto formula = h.getObjectVal(Object::FIRST, Color::RED);
+  auto res = solutions::findUpTo(formula, 5);
+  EXPECT_EQ(res.size(), 5);
+  EXPECT_EQ(std::set(res.begin(), res.end()).size(), 5);
+  for (auto &varset : res)
+    EXPECT_NE(toCube(varset) & formula, bdd_false());
+
+  // Formula with exactly two combinations
+  auto first = toCube(*solutions::findOne(formula));
+  auto second = toCube(*solutions::findOne(formula & not first));
+  EXPECT_EQ(solutions::findUpTo(first | second, 10).size(), 2);
+  EXPECT_TRUE(solutions::findUpTo(bdd_false(), 10).empty());
+}
+
+#endif
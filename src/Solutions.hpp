@@ -0,0 +1,158 @@
+#ifndef SOLUTIONS_HPP
+#define SOLUTIONS_HPP
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <limits>
+#include <iterator>
+#include <ostream>
+#include <functional>
+#include "bdd.h"
+
+/**
+ * Here we extract suitable variables values combinations
+ * from result formula.
+ *
+ * bdd_allsat visits ALL the combinations, even if we need
+ * only one of them. Functions below stop as soon as they have
+ * enough combinations, so the cost is proportional to the
+ * number of variables, not to the number of combinations.
+ */
+namespace solutions
+{
+  /**
+   * One full combination of variables values.
+   * varset[i] is value (0 or 1, NOT '0' or '1') of variable i.
+   * Same format as bdd_allsat gives, but without -1 (don't care) values.
+   */
+  using VarSet = std::string;
+
+  /**
+   * Lazy range of suitable combinations.
+   * ```
+   * for (auto &varset : SolutionRange(formula, 1000))
+   *   consume(varset);
+   * ```
+   * Each combination is computed only when iterator is incremented,
+   * so we can stop at any moment and pay nothing for the rest.
+   *
+   * We walk formula with our own stack instead of recursion,
+   * so any number of variables is fine. Stack and varset buffer are
+   * allocated once, all the combinations are written into the same buffer.
+   * That is why reference you get from iterator is valid only until next increment.
+   * Copy it if you need to keep it.
+   *
+   * Range can be resumed. If you stopped iterating (for example with
+   * std::views::take or break) - next begin() continues after the last
+   * combination you got, each combination is given once.
+   */
+  class SolutionRange
+  {
+  public:
+    static constexpr std::size_t unlimited = std::numeric_limits< std::size_t >::max();
+
+    class Iterator
+    {
+    public:
+      using value_type = VarSet;
+      using difference_type = std::ptrdiff_t;
+
+      Iterator() = default;
+      const VarSet &operator*() const;
+      Iterator &operator++();
+      void operator++(int);
+      bool operator==(std::default_sentinel_t) const;
+
+    private:
+      friend class SolutionRange;
+      explicit Iterator(SolutionRange *range);
+      SolutionRange *range_ = nullptr;
+    };
+
+    /**
+     * Range over combinations of formula.
+     * No more than limit combinations will be produced.
+     */
+    explicit SolutionRange(const bdd &formula, std::size_t limit = unlimited);
+
+    /**
+     * Range over combinations of formula where variables at the first
+     * nFixedLevels levels are fixed. Their values are bits of fixedValues,
+     * the first level is the highest bit.
+     * For example SolutionRange(f, 2, 0b10) gives combinations where
+     * first variable is 1 and second is 0.
+     * Other words, it's range over cofactor of formula.
+     */
+    SolutionRange(const bdd &formula, int nFixedLevels, unsigned fixedValues,
+                  std::size_t limit = unlimited);
+
+    Iterator begin();
+    std::default_sentinel_t end() const;
+
+    // How many combinations were produced so far.
+    std::size_t produced() const;
+
+  private:
+    // Decision made at one level.
+    struct Frame
+    {
+      int node;   // Node we have before deciding current level variable
+      int branch; // Variable value we chose, 0 or 1
+    };
+
+    bool next();
+    void resume();
+    void descend();
+    int child(int node, int level, int branch) const;
+
+    bdd formula_;
+    int nLevels_;
+    int nFixedLevels_;
+    std::vector< Frame > stack_;
+    VarSet current_;
+    std::size_t limit_;
+    std::size_t produced_;
+    bool started_;
+    bool finished_;
+    // Current combination was given by iterator, begin() must go to next one
+    bool delivered_;
+  };
+
+  /**
+   * Return one suitable combination or nothing if formula is false.
+   * Built on bdd_fullsatone, so only one path from root to true is walked.
+   */
+  std::optional< VarSet > findOne(const bdd &formula);
+
+  /**
+   * Return up to k different suitable combinations.
+   * If formula has less than k combinations - return all of them.
+   */
+  std::vector< VarSet > findUpTo(const bdd &formula, std::size_t k);
+
+  // Writes one combination to shard output. See enumerateSharded.
+  using ShardWriter = std::function< void(std::ostream &out, const VarSet &varset) >;
+
+  /**
+   * Enumerate ALL combinations of formula using several threads.
+   *
+   * Formula is split on its first splitLevels variables into
+   * 2^splitLevels parts (cofactors) that have no common combinations.
+   * Parts are walked by hardware_concurrency threads, each part is
+   * written to its own shard with write function.
+   * So shards.size() must be 2^splitLevels.
+   *
+   * Shard i gets combinations where first splitLevels variables,
+   * read as binary number, are equal to i. So if you print shards
+   * one after another, you get the same order as SolutionRange gives.
+   *
+   * Nodes are only read in threads, so it's safe, but don't
+   * create any bdd while enumeration is running.
+   */
+  void enumerateSharded(const bdd &formula, int splitLevels,
+                        const std::vector< std::ostream * > &shards, const ShardWriter &write);
+}
+
+#endif
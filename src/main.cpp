@@ -1,197 +1,375 @@
-#include <iostream>
-#include <vector>
-#include <ranges>
-#include <algorithm>
-#include "bdd.h"
-#include "BDDHelper.hpp"
-#include "BDDFormulaBuilder.hpp"
-#include "Conditions.hpp"
-#include "PrintHelper.hpp"
-
-/**
- * The key idea is next. We have some objects that have some
- * properties. We need to choose combinations of objects properties
- * according to the conditions.
- * Conditions, for example, red house is near white.
- * Or 4e4enec lives with dog.
- *
- * We will create function, that gets combination of objects properties
- * and return true if all the conditions are satisfied, and false if not.
- *
- * > Just feel the idea. Don't try to understand river from single bucket with water...
- * 
- * So we say, let's create nValuesVars, so that
- * var[0] var[1] var[2] var[3] will set first object's FIRST property value.
- * We can set var[0] var[1] var[2] var[3] as 0001 - first object's first property
- * value is second. In my program this means first object's Color is Green.
- *
- * var[4] var[5] var[6] var[7] will set first object's SECOND property value.
- * We can set var[4] var[5] var[6] var[7] as 0001 - first object's SECOND property
- * value is second. In my program this means first object's Nation is Belarus.
- *
- * Objects in my program like houses, which has Color, where lives Nation person,
- * that has some Plant and has some Animal. Yet i'm not high btw...
- */
-
-using namespace bddHelper;
-
-template < class T > using vect = std::vector< T >;
-
-// We have nObjs objects
-constexpr int nObjs = bddHelper::BDDHelper::nObjs;
-
-// Each object has nProps properties, for example
-// Color, Animal, Plant
-constexpr int nProps = bddHelper::BDDHelper::nProps;
-
-/**Each property has nVals variants, for example
-   property Color has Green Red Blue...,
-   property Animal has Bird Cat Dog...*/
-constexpr int nVals = bddHelper::BDDHelper::nVals;
-
-/**We have 9 values of each property. To code 9 values
-   we need 4 bits. So first value is 0000, next is 0001...
-   The last will be 1000, so we will need to remove trash
-   combinations like 1001, 1010... because these do not
-   make sense for us*/
-constexpr int nValueBits = bddHelper::BDDHelper::nValueBits;
-
-/** Each value of property is 4 bits(variables), we have nObjs that
-   have nProps, that means we need nObjs * nProps * nValueBits
-   to code each objects property value.*/
-constexpr int nValuesVars = bddHelper::BDDHelper::nValuesVars;
-
-// Actually it's same as nValuesVars.
-constexpr int nTotalVars = bddHelper::BDDHelper::nTotalVars;
-
-// We will use it to call function exactly one time over program life.
-std::once_flag once;
-// Here we will save one suitable combination of variables values
-std::string varset;
-
-/** This function is used to visit all the suitable
-   variables values combination.
-   @note See pattern Visitor.
- */
-void extractSet(char *varset_, int size)
-{
-  std::call_once(once, [&]() {
-    varset = std::string(varset_, size);
-  });
-}
-
-// Nothing interesting, just printing results
-void printProp(Property prop, int valNum)
-{
-  switch (prop)
-  {
-    case Property::ANIMAL:
-      std::cout << to_string(static_cast< Animal >(valNum)) << '\n';
-      break;
-
-    case Property::COLOR:
-      std::cout << to_string(static_cast< Color >(valNum)) << '\n';
-      break;
-
-    case Property::NATION:
-      std::cout << to_string(static_cast< Nation >(valNum)) << '\n';
-      break;
-
-    case Property::PLANT:
-      std::cout << to_string(static_cast< Plant >(valNum)) << '\n';
-      break;
-  }
-}
-
-// Nothing interesting, just printing results
-void printObjects()
-{
-  if (varset.empty())
-  {
-    std::cout << "No suitable object property value combination was found.\n";
-    return;
-  }
-  if (varset.size() != nTotalVars)
-  {
-    std::cout << "Array varset must contain 144 values.\
-                  Otherwise there is an error in calculations.\n";
-    return;
-  }
-  for (auto objNum : std::views::iota(0, nObjs))
-  {
-    auto obj = static_cast< Object >(objNum);
-    std::cout << to_string(obj) << " {\n";
-    for (auto propNum : std::views::iota(0, nProps))
-    {
-      auto prop = static_cast< Property >(propNum);
-      std::cout << '\t' << to_string(prop) << ": ";
-      auto baseIndex = objNum * nProps * nValueBits + propNum * nValueBits;
-      int valNum = (varset.at(baseIndex) << 3) +
-                   (varset.at(baseIndex + 1) << 2) +
-                   (varset.at(baseIndex + 2) << 1) +
-                   (varset.at(baseIndex + 3) << 0);
-      printProp(prop, valNum);
-    }
-    std::cout << "}\n";
-  }
-}
-
-int main()
-{
-  // Let's give bdd some memory. You can change it according to your needs.
-  bdd_init(3000000, 100000);
-  // Let's create bdd variables. They described in the up.
-  bdd_setvarnum(BDDHelper::nTotalVars);
-  // Array to save all these variables.
-  // vars[0] will contain first var
-  // vars[1] will contain second var
-  // vars[2]...
-  std::vector< bdd > vars(nTotalVars);
-  { // Here we just put all these variables in array.
-    int i = 0;
-    std::generate(std::begin(vars), std::end(vars),
-      [&i]() {
-      return bdd_ithvar(i++);
-    });
-  }
-  /**
-   * Of course vars contains each objects property variables.
-     And we can access for example second objects second property vars by
-     vars[nProps*nVaueBits*1 + nValueBits],
-     vars[nProps*nVaueBits*1 + nValueBits + 1]
-     vars[nProps*nVaueBits*1 + nValueBits + 2]
-     vars[nProps*nVaueBits*1 + nValueBits + 3].
-     But it's just \b fucking \b disgusting.
-     I create that array v, so that we can access
-     second objects second property by structedVars[1][1].
-     Dont forget that arrays indexes start with \b 0, not \b 1.
-     */
-  auto structedVars = vect< vect< vect< bdd > > >(nObjs);
-  for (auto objNum : std::views::iota(0, nObjs))
-  {
-    structedVars[objNum] = vect< vect< bdd > >(nProps);
-    for (auto propNum : std::views::iota(0, nProps))
-    {
-      auto baseIndex = objNum * nProps * nValueBits + propNum * nValueBits;
-      structedVars[objNum][propNum] = vect< bdd >{
-        bdd_ithvar(baseIndex + 0),
-        bdd_ithvar(baseIndex + 1),
-        bdd_ithvar(baseIndex + 2),
-        bdd_ithvar(baseIndex + 3) };
-    }
-  }
-  // Let's explore what is BDDHelper
-  bddHelper::BDDHelper h(structedVars);
-  // Simpliest class in the world. Just contains result formula.
-  BDDFormulaBuilder builder;
-  conditions::addConditions(h, builder);
-  std::cout << "Bdd formula created. Starting counting sets...\n";
-  std::cout << "Count of true variables values combinations: " << bdd_satcount(builder.result()) << '\n';
-  std::cout << "Objects are...\n";
-  // Iterate over true combinations and extract one of them in varset variable.
-  bdd_allsat(builder.result(), extractSet);
-  // Print one of suitable objects properties combinations
-  printObjects();
-  bdd_done();
-  return 0;
-}
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <ranges>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include "bdd.h"
+#include "BDDHelper.hpp"
+#include "BDDFormulaBuilder.hpp"
+#include "BDDManager.hpp"
+#include "Conditions.hpp"
+#include "PrintHelper.hpp"
+#include "Solutions.hpp"
+#include "Analysis.hpp"
+#include "OrderSearch.hpp"
+#include "MainOptions.hpp"
+
+/**
+ * The key idea is next. We have some objects that have some
+ * properties. We need to choose combinations of objects properties
+ * according to the conditions.
+ * Conditions, for example, red house is near white.
+ * Or 4e4enec lives with dog.
+ *
+ * We will create function, that gets combination of objects properties
+ * and return true if all the conditions are satisfied, and false if not.
+ *
+ * > Just feel the idea. Don't try to understand river from single bucket with water...
+ * 
+ * So we say, let's create nValuesVars, so that
+ * var[0] var[1] var[2] var[3] will set first object's FIRST property value.
+ * We can set var[0] var[1] var[2] var[3] as 0001 - first object's first property
+ * value is second. In my program this means first object's Color is Green.
+ *
+ * var[4] var[5] var[6] var[7] will set first object's SECOND property value.
+ * We can set var[4] var[5] var[6] var[7] as 0001 - first object's SECOND property
+ * value is second. In my program this means first object's Nation is Belarus.
+ *
+ * Objects in my program like houses, which has Color, where lives Nation person,
+ * that has some Plant and has some Animal. Yet i'm not high btw...
+ */
+
+using namespace bddHelper;
+using mainOptions::Options;
+
+// We have nObjs objects
+constexpr int nObjs = bddHelper::BDDHelper::nObjs;
+
+// Each object has nProps properties, for example
+// Color, Animal, Plant
+constexpr int nProps = bddHelper::BDDHelper::nProps;
+
+/**Each property has nVals variants, for example
+   property Color has Green Red Blue...,
+   property Animal has Bird Cat Dog...*/
+constexpr int nVals = bddHelper::BDDHelper::nVals;
+
+/**We have 9 values of each property. To code 9 values
+   we need 4 bits. So first value is 0000, next is 0001...
+   The last will be 1000, so we will need to remove trash
+   combinations like 1001, 1010... because these do not
+   make sense for us*/
+constexpr int nValueBits = bddHelper::BDDHelper::nValueBits;
+
+/** Each value of property is 4 bits(variables), we have nObjs that
+   have nProps, that means we need nObjs * nProps * nValueBits
+   to code each objects property value.*/
+constexpr int nValuesVars = bddHelper::BDDHelper::nValuesVars;
+
+// Actually it's same as nValuesVars.
+constexpr int nTotalVars = bddHelper::BDDHelper::nTotalVars;
+
+// Nothing interesting, just printing results
+void printProp(std::ostream &out, Property prop, int valNum)
+{
+  out << to_string(prop, valNum) << '\n';
+}
+
+// Nothing interesting, just printing results
+void printObjects(std::ostream &out, const BDDHelper &h, const std::string &varset)
+{
+  if (varset.empty())
+  {
+    out << "No suitable object property value combination was found.\n";
+    return;
+  }
+  if (static_cast< int >(varset.size()) < h.nVars())
+  {
+    out << "Array varset must contain at least " << h.nVars() << " values.\
+                  Otherwise there is an error in calculations.\n";
+    return;
+  }
+  for (auto objNum : std::views::iota(0, nObjs))
+  {
+    auto obj = static_cast< Object >(objNum);
+    out << to_string(obj) << " {\n";
+    for (auto propNum : std::views::iota(0, nProps))
+    {
+      auto prop = static_cast< Property >(propNum);
+      out << '\t' << to_string(prop) << ": ";
+      // Where bits are depends on variables order and encoding, so ask h
+      printProp(out, prop, h.getValNum(obj, prop, varset));
+    }
+    out << "}\n";
+  }
+}
+
+// Print how many combinations have each object property value.
+// Values that no combination has are skipped.
+void printMarginals(const analysis::Marginals &marginals)
+{
+  for (auto objNum : std::views::iota(0, nObjs))
+  {
+    auto obj = static_cast< Object >(objNum);
+    std::cout << to_string(obj) << " {\n";
+    for (auto propNum : std::views::iota(0, nProps))
+    {
+      auto prop = static_cast< Property >(propNum);
+      std::cout << '\t' << to_string(prop) << ":";
+      for (auto valNum : std::views::iota(0, nVals))
+      {
+        auto count = marginals.counts[objNum][propNum][valNum];
+        if (count != 0)
+          std::cout << ' ' << to_string(prop, valNum) << '=' << count;
+      }
+      std::cout << '\n';
+    }
+    std::cout << "}\n";
+  }
+}
+
+// Print forced value of each object property,
+// or values it still may have if nothing is forced.
+void printBackbone(const analysis::Backbone &backbone)
+{
+  for (auto objNum : std::views::iota(0, nObjs))
+  {
+    auto obj = static_cast< Object >(objNum);
+    std::cout << to_string(obj) << " {\n";
+    for (auto propNum : std::views::iota(0, nProps))
+    {
+      auto prop = static_cast< Property >(propNum);
+      std::cout << '\t' << to_string(prop) << ":";
+      auto &forced = backbone.forced[objNum][propNum];
+      auto &impossible = backbone.impossible[objNum][propNum];
+      if (auto it = std::ranges::find(forced, true); it != forced.end())
+        std::cout << ' ' << to_string(prop, static_cast< int >(it - forced.begin()));
+      else
+      {
+        std::cout << " one of";
+        for (auto valNum : std::views::iota(0, nVals))
+          if (not impossible[valNum])
+            std::cout << ' ' << to_string(prop, valNum);
+      }
+      std::cout << '\n';
+    }
+    std::cout << "}\n";
+  }
+}
+
+// Formula is built, so no more reordering.
+// Print how much time reorderings took and how many nodes they saved.
+void stopReorder(const Options &options)
+{
+  if (options.reorderMethod == BDD_REORDER_NONE and not options.siftGroups)
+    return;
+  BDDHelper::disableReorder();
+  auto &stats = BDDHelper::reorderStats();
+  std::cout << "Variables reordered " << stats.nReorders << " times in " << stats.seconds << " s";
+  if (stats.nReorders > 0)
+    std::cout << ", live nodes " << stats.nodesBefore << " -> " << stats.nodesAfter;
+  std::cout << '\n';
+}
+
+// Print all combinations. If asked - in several threads.
+// False if some shard file can't be written, error is already printed.
+bool printAllObjects(const bdd &formula, const BDDHelper &h, const Options &options)
+{
+  auto write = [&h](std::ostream &out, const std::string &varset) {
+    printObjects(out, h, varset);
+  };
+  if (options.splitLevels == 0)
+  {
+    for (auto &varset : solutions::SolutionRange(formula))
+      write(std::cout, varset);
+    return true;
+  }
+  auto nShards = 1 << options.splitLevels;
+  std::vector< std::unique_ptr< std::ostream > > shards;
+  std::vector< std::ostream * > shardPtrs;
+  auto shardName = [&options](int shardNum) {
+    return options.shardsPrefix + std::to_string(shardNum);
+  };
+  for (auto shardNum : std::views::iota(0, nShards))
+  {
+    if (options.shardsPrefix.empty())
+      shards.push_back(std::make_unique< std::ostringstream >());
+    else
+    {
+      // Check before enumeration, so nothing is walked for nothing
+      auto file = std::make_unique< std::ofstream >(shardName(shardNum));
+      if (not *file)
+      {
+        std::cerr << "Can't open " << shardName(shardNum) << '\n';
+        return false;
+      }
+      shards.push_back(std::move(file));
+    }
+    shardPtrs.push_back(shards.back().get());
+  }
+  solutions::enumerateSharded(formula, options.splitLevels, shardPtrs, write);
+  if (options.shardsPrefix.empty())
+  {
+    // Shards go one after another, so order is the same as in one thread.
+    for (auto &shard : shards)
+      std::cout << static_cast< std::ostringstream & >(*shard).str();
+    return true;
+  }
+  for (auto shardNum : std::views::iota(0, nShards))
+  {
+    auto &file = static_cast< std::ofstream & >(*shards[shardNum]);
+    file.close();
+    if (not file)
+    {
+      std::cerr << "Can't write combinations to " << shardName(shardNum) << '\n';
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  auto options = mainOptions::parseOptions(argc, argv);
+  if (not options)
+  {
+    std::cerr << "Usage: " << argv[0] << " [--all] [--split K [--shards NAME]] [--marginals] [--backbone]"
+                 " [--schedule sequential|cluster] [--peak]"
+                 " [--project color|nation|plant|animal] [--order object|property|bits]"
+                 " [--reorder sift|siftite|win2ite|win3ite|groups [--reorder-times N]] [--nodes N] [--cache N] [--huge-pages]"
+                 " [--encoding binary|fdd|onehot] [--unique pairwise|alldiff | --dual] [--order-file FILE] [--force-order]\n";
+    return 1;
+  }
+  // Let's give bdd some memory. You can change it with --nodes and --cache according to your needs.
+  // Garbage collections are not printed, they would get mixed with combinations.
+  BDDManager manager(options->nodes, options->cacheSize, true);
+  if (options->hugePages)
+  {
+    auto pages = manager.useHugePages();
+    if (pages)
+      std::cout << "Nodes table on huge pages: " << (pages.advised >> 20) << " MB, "
+                << (pages.collapsed >> 20) << " MB of them already collapsed\n";
+    else
+      std::cout << "Huge pages are not available, normal pages are used\n";
+  }
+  // Let's create bdd variables, they are described in the up. Where bits of
+  // each object property are depends on --order, see BDDHelper::varIndex.
+  // Nobody but BDDHelper knows it, conditions get variables from h.
+  auto h = options->encoding == Encoding::FDD ? BDDHelper::withFdd(options->order) :
+           options->encoding == Encoding::ONE_HOT ? BDDHelper::withOneHot(options->order) :
+           BDDHelper::withBinary(options->order);
+  // Tuned order. It's set before any condition is created, so nothing is reordered.
+  if (not options->orderFile.empty())
+  {
+    std::ifstream file(options->orderFile);
+    auto order = orderSearch::readOrder(file);
+    if (not order)
+    {
+      std::cerr << "Bad order file " << options->orderFile << '\n';
+      return 1;
+    }
+    h.setGroupOrder(*order);
+  }
+  // Collects conditions and joins them into result formula.
+  BDDFormulaBuilder builder(options->strategy);
+  builder.setTrackPeak(options->peak);
+  // Its variables go after ours, so it's created after order is set
+  std::optional< dualModel::DualModel > dual;
+  if (options->dual)
+    dual.emplace(h);
+  conditions::addConditions(h, builder, options->uniqueness, dual ? &*dual : nullptr);
+  if (options->forceOrder)
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto current = h.getGroupOrder();
+    auto order = orderSearch::forceOrder(h, builder.pending());
+    std::cout << "Variables order computed in "
+              << std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count() << " s\n";
+    // Heuristic only guesses. For this puzzle, for example, it puts the same
+    // property of all objects together, which is worse than default order.
+    // So we join once with both orders and keep new one only if it's better.
+    // New order is not finished if it gets worse than current one.
+    auto was = orderSearch::evaluate(h, builder.pending(), current, std::numeric_limits< int >::max());
+    auto now = orderSearch::evaluate(h, builder.pending(), order, was.peakLiveNodes);
+    auto isBetter = not now.aborted and now.peakLiveNodes < was.peakLiveNodes;
+    h.setGroupOrder(isBetter ? order : current);
+    std::cout << "Peak live nodes with current order " << was.peakLiveNodes << ", with computed one "
+              << (now.aborted ? "stopped at " : "") << now.peakLiveNodes << ". "
+              << (isBetter ? "Computed" : "Current") << " order is used\n";
+  }
+  // Reordering is enabled only now, right before conditions are joined:
+  // order above is set with setGroupOrder, which can't be used after addVarBlocks.
+  if (options->reorderMethod != BDD_REORDER_NONE)
+  {
+    h.addVarBlocks();
+    BDDHelper::enableReorder(options->reorderMethod, options->reorderTimes);
+  }
+  if (options->siftGroups)
+  {
+    // Our own sifting, BuDDy doesn't reorder by itself
+    builder.setReorder([&h, times = options->reorderTimes](const std::vector< bdd > &formulas) {
+      if (BDDHelper::reorderStats().nReorders < times)
+        h.siftGroups(formulas);
+    });
+  }
+  if (options->project)
+  {
+    auto keepVars = h.getPropertyVarSet(*options->project);
+    auto projected = builder.project(keepVars);
+    auto &stats = builder.stats();
+    std::cout << "Projection created. Joined " << stats.nJoined << " conditions in " << stats.seconds << " s, ";
+    if (options->peak)
+      std::cout << "peak live nodes " << stats.peakLiveNodes << ", ";
+    std::cout << "result nodes " << stats.resultNodes << '\n';
+    stopReorder(*options);
+    std::cout << "Count of different " << to_string(*options->project) << " arrangements: "
+              << bdd_satcountset(projected, keepVars) << '\n';
+    return 0;
+  }
+  builder.result();
+  auto &stats = builder.stats();
+  std::cout << "Bdd formula created. Joined " << stats.nJoined << " conditions in " << stats.seconds << " s, ";
+  if (options->peak)
+    std::cout << "peak live nodes " << stats.peakLiveNodes << ", ";
+  std::cout << "result nodes " << stats.resultNodes << '\n';
+  stopReorder(*options);
+  std::cout << "Starting counting sets...\n";
+  if (dual)
+  {
+    // Position variables are determined by values, so formula has
+    // as many combinations as each of models. Count with the smaller one.
+    auto [model, varSet] = dual->smallerModel(builder.result());
+    std::cout << "Count of true variables values combinations: " << bdd_satcountset(model, varSet)
+              << " (" << (varSet == dual->getDualVarSet() ? "dual" : "primary") << " model, "
+              << bdd_nodecount(model) << " nodes)\n";
+  }
+  else
+    std::cout << "Count of true variables values combinations: " << bdd_satcount(builder.result()) << '\n';
+  if (options->marginals)
+  {
+    std::cout << "Combinations count for each value...\n";
+    printMarginals(analysis::computeMarginals(builder.result(), h));
+  }
+  if (options->backbone)
+  {
+    std::cout << "Determined values...\n";
+    printBackbone(analysis::computeBackbone(builder.result(), h));
+  }
+  std::cout << "Objects are...\n";
+  if (options->all)
+  {
+    return printAllObjects(builder.result(), h, *options) ? 0 : 1;
+  }
+  // Extract one of true combinations. We stop right after first one is found,
+  // so we don't walk all the combinations like bdd_allsat does.
+  auto varset = solutions::findOne(builder.result());
+  // Print one of suitable objects properties combinations
+  printObjects(std::cout, h, varset.value_or(""));
+  return 0;
+}
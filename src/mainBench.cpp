@@ -0,0 +1,421 @@
+#include <iostream>
+#include <iomanip>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <ranges>
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+#include "bdd.h"
+#include "BDDHelper.hpp"
+#include "BDDFormulaBuilder.hpp"
+#include "BDDManager.hpp"
+#include "Conditions.hpp"
+#include "DualModel.hpp"
+#include "NodeTable.hpp"
+#include "HashStats.hpp"
+#include "ApplyStats.hpp"
+#include "Arguments.hpp"
+// BuDDy prime table sizes, the header has no extern "C" of its own
+extern "C"
+{
+#include "prime.h"
+}
+
+/**
+ * Tool that compares ways to code the puzzle: encodings,
+ * ways to say that values are unique and dual model.
+ * Each way is run in fresh BuDDy: conditions are created,
+ * joined and solutions are counted. Time of each step, nodes
+ * created while conditions are made and formula sizes are printed,
+ * one line per way.
+ *
+ * --order O   Variables order: object, property or bits. Default is object.
+ * --nodes N   Initial size of BuDDy nodes table. Default is 3000000.
+ * --cache N   Size of BuDDy operations caches. Default is 100000.
+ * --huge-pages on|off  Put BuDDy nodes table on huge pages, see
+ *             BDDManager::useHugePages. Default is off.
+ * --traversal N  Also count solutions of each result formula N times
+ *             with bdd_satcount and with node table (see NodeTable.hpp)
+ *             and print nanoseconds per node for both.
+ * --hash-stats on|off  Put nodes of conditions and result into a full
+ *             table (prime number of buckets, about one per node, as
+ *             bdd_init sizes it) with BuDDy hash and with mixing one,
+ *             and print chain lengths (see HashStats.hpp). Default is off.
+ * --apply-stats on|off  Count repeated operations while conditions are
+ *             created and while they are joined, and print hit rates of
+ *             ideal operation cache for each operator (see ApplyStats.hpp).
+ *             Default is off.
+ */
+
+using namespace bddHelper;
+
+struct Options
+{
+  VarOrder order = VarOrder::OBJECT_MAJOR;
+  int nodes = 3000000;
+  int cacheSize = 100000;
+  int traversalRepeats = 0;
+  bool hugePages = false;
+  bool hashStats = false;
+  bool applyStats = false;
+};
+
+/**
+ * bdd_bench is linked with -Wl,--wrap for these functions, so BuDDy
+ * calls from our code come here, and they are recorded for --apply-stats.
+ * applyStats::record does nothing unless it's started.
+ */
+extern "C"
+{
+  BDD __real_bdd_apply(BDD left, BDD right, int op);
+  BDD __real_bdd_not(BDD operand);
+  BDD __real_bdd_ite(BDD f, BDD g, BDD h);
+
+  BDD __wrap_bdd_apply(BDD left, BDD right, int op)
+  {
+    auto res = __real_bdd_apply(left, right, op);
+    applyStats::record(op, left, right, -1, res);
+    return res;
+  }
+
+  BDD __wrap_bdd_not(BDD operand)
+  {
+    auto res = __real_bdd_not(operand);
+    applyStats::record(bddop_not, operand, -1, -1, res);
+    return res;
+  }
+
+  BDD __wrap_bdd_ite(BDD f, BDD g, BDD h)
+  {
+    auto res = __real_bdd_ite(f, g, h);
+    applyStats::record(applyStats::opIte, f, g, h, res);
+    return res;
+  }
+}
+
+// Time of walking result formula, see --traversal
+struct Traversal
+{
+  std::string name;
+  int nodes = 0;
+  double buddyNs = 0;   // bdd_satcount, per node
+  double collectNs = 0; // Copying nodes to node table, per node
+  double tableNs = 0;   // nodeTable::satCount, per node
+};
+
+// Chains of unique table for nodes of one case, see --hash-stats
+struct HashReport
+{
+  std::string name;
+  hashStats::ChainStats buddy;
+  hashStats::ChainStats mix;
+};
+
+// Operators of one phase of one case, see --apply-stats
+struct ApplyReport
+{
+  std::string name;
+  std::string_view phase;
+  std::vector< applyStats::OpStats > stats;
+};
+
+// What a case reports besides its line of the main table
+struct Extra
+{
+  std::optional< Traversal > traversal;
+  std::optional< HashReport > hashReport;
+  std::vector< ApplyReport > applyReports;
+};
+
+using conditions::Uniqueness;
+
+// One way to code the puzzle
+struct Case
+{
+  std::string_view name;
+  std::function< BDDHelper(VarOrder order) > createHelper;
+  Uniqueness uniqueness;
+  bool dual = false;
+};
+
+const Case cases[] = {
+  { "binary", BDDHelper::withBinary, Uniqueness::PAIRWISE },
+  { "fdd", BDDHelper::withFdd, Uniqueness::PAIRWISE },
+  { "onehot", BDDHelper::withOneHot, Uniqueness::PAIRWISE },
+  { "binary", BDDHelper::withBinary, Uniqueness::ALL_DIFFERENT },
+  { "fdd", BDDHelper::withFdd, Uniqueness::ALL_DIFFERENT },
+  { "onehot", BDDHelper::withOneHot, Uniqueness::ALL_DIFFERENT },
+  { "binary", BDDHelper::withBinary, Uniqueness::PAIRWISE, true }
+};
+
+std::optional< Options > parseOptions(int argc, char *argv[])
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string_view arg = argv[i];
+    if (i + 1 >= argc)
+      return std::nullopt;
+    if (arg == "--order")
+    {
+      auto value = arguments::parseName(arguments::orderNames, argv[++i]);
+      if (not value)
+        return std::nullopt;
+      options.order = *value;
+    }
+    else if (arg == "--nodes")
+    {
+      auto nodes = arguments::parseNumber< int >(argv[++i]);
+      if (not nodes or *nodes <= 0)
+        return std::nullopt;
+      options.nodes = *nodes;
+    }
+    else if (arg == "--cache")
+    {
+      auto cacheSize = arguments::parseNumber< int >(argv[++i]);
+      if (not cacheSize or *cacheSize <= 0)
+        return std::nullopt;
+      options.cacheSize = *cacheSize;
+    }
+    else if (arg == "--huge-pages")
+    {
+      std::string_view mode = argv[++i];
+      if (mode != "on" and mode != "off")
+        return std::nullopt;
+      options.hugePages = mode == "on";
+    }
+    else if (arg == "--hash-stats")
+    {
+      std::string_view mode = argv[++i];
+      if (mode != "on" and mode != "off")
+        return std::nullopt;
+      options.hashStats = mode == "on";
+    }
+    else if (arg == "--apply-stats")
+    {
+      std::string_view mode = argv[++i];
+      if (mode != "on" and mode != "off")
+        return std::nullopt;
+      options.applyStats = mode == "on";
+    }
+    else if (arg == "--traversal")
+    {
+      auto repeats = arguments::parseNumber< int >(argv[++i]);
+      if (not repeats or *repeats <= 0)
+        return std::nullopt;
+      options.traversalRepeats = *repeats;
+    }
+    else
+      return std::nullopt;
+  }
+  return options;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+}
+
+// Nodes BuDDy has created since it was initialized
+long producedNodes()
+{
+  bddStat stat;
+  bdd_stats(&stat);
+  return stat.produced;
+}
+
+/**
+ * Count solutions of formula repeats times with BuDDy and with node table.
+ * BuDDy remembers counts of nodes in its cache, so cache is cleared
+ * (by garbage collection) before each count. It's not timed.
+ */
+Traversal measureTraversal(const bdd &formula, int repeats)
+{
+  Traversal res;
+  res.nodes = bdd_nodecount(formula);
+  double buddySeconds = 0;
+  double count = 0;
+  for (auto repeat : std::views::iota(0, repeats))
+  {
+    (void)repeat;
+    bdd_gbc();
+    auto start = std::chrono::steady_clock::now();
+    count += bdd_satcount(formula);
+    buddySeconds += secondsSince(start);
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto table = nodeTable::collectNodes(formula);
+  auto collectSeconds = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  for (auto repeat : std::views::iota(0, repeats))
+  {
+    (void)repeat;
+    count -= nodeTable::satCount(table);
+  }
+  auto tableSeconds = secondsSince(start);
+  assert(count == 0 && "Node table counts differently");
+  auto perNode = 1e9 / std::max(res.nodes, 1);
+  res.buddyNs = buddySeconds / repeats * perNode;
+  res.collectNs = collectSeconds * perNode;
+  res.tableNs = tableSeconds / repeats * perNode;
+  return res;
+}
+
+// Each case has its own manager, so cases don't share nodes or caches
+Extra run(const Case &benchCase, const Options &options)
+{
+  BDDManager manager(options.nodes, options.cacheSize, true);
+  if (options.hugePages and not manager.useHugePages())
+    std::cerr << "Huge pages are not available, normal pages are used\n";
+  if (options.applyStats)
+    applyStats::start();
+  auto start = std::chrono::steady_clock::now();
+  auto producedBefore = producedNodes();
+  auto h = benchCase.createHelper(options.order);
+  std::optional< dualModel::DualModel > dual;
+  if (benchCase.dual)
+    dual.emplace(h);
+  BDDFormulaBuilder builder;
+  builder.setTrackPeak(true);
+  conditions::addConditions(h, builder, benchCase.uniqueness, dual ? &*dual : nullptr);
+  auto nConditions = builder.pending().size();
+  auto createSeconds = secondsSince(start);
+  auto createProduced = producedNodes() - producedBefore;
+  auto createApplies = applyStats::takeStats();
+
+  auto formula = builder.result();
+  auto joinApplies = applyStats::takeStats();
+  applyStats::stop();
+  auto &stats = builder.stats();
+  std::string_view unique = benchCase.dual ? "dual" : arguments::nameOf(arguments::uniquenessNames, benchCase.uniqueness);
+
+  start = std::chrono::steady_clock::now();
+  auto count = bdd_satcount(formula);
+  auto countSeconds = secondsSince(start);
+
+  std::cout << std::left << std::setw(10) << benchCase.name
+            << std::setw(10) << unique
+            << std::right
+            << std::setw(12) << nConditions
+            << std::setw(12) << createSeconds
+            << std::setw(12) << createProduced
+            << std::setw(12) << stats.seconds
+            << std::setw(12) << stats.peakLiveNodes
+            << std::setw(12) << stats.resultNodes
+            << std::setw(12) << countSeconds
+            << std::setw(14) << count << '\n';
+
+  Extra extra;
+  auto name = std::string(benchCase.name) + ' ' + std::string(unique);
+  if (options.applyStats)
+    extra.applyReports = { { name, "create", createApplies }, { name, "join", joinApplies } };
+  if (options.traversalRepeats)
+  {
+    extra.traversal = measureTraversal(formula, options.traversalRepeats);
+    extra.traversal->name = name;
+  }
+  if (options.hashStats)
+  {
+    // Nodes that are alive at the end. BuDDy grows its table only when
+    // it's full, so chains are the longest with one bucket per node.
+    // Table size is prime, as bdd_init makes it.
+    auto formulas = builder.pending();
+    formulas.push_back(formula);
+    auto keys = hashStats::collectKeys(formulas);
+    std::size_t nBuckets = bdd_prime_gte(static_cast< unsigned >(keys.size()));
+    extra.hashReport = HashReport{ name,
+                                   hashStats::chainStats(keys, nBuckets, hashStats::Hash::BUDDY),
+                                   hashStats::chainStats(keys, nBuckets, hashStats::Hash::MIX) };
+  }
+  return extra;
+}
+
+int main(int argc, char *argv[])
+{
+  auto options = parseOptions(argc, argv);
+  if (not options)
+  {
+    std::cerr << "Usage: " << argv[0] << " [--order object|property|bits] [--nodes N] [--cache N] [--huge-pages on|off] [--traversal N] [--hash-stats on|off] [--apply-stats on|off]\n";
+    return 1;
+  }
+  std::cout << std::left << std::setw(10) << "encoding" << std::setw(10) << "unique" << std::right
+            << std::setw(12) << "conditions"
+            << std::setw(12) << "create s"
+            << std::setw(12) << "new nodes"
+            << std::setw(12) << "join s"
+            << std::setw(12) << "peak nodes"
+            << std::setw(12) << "nodes"
+            << std::setw(12) << "count s"
+            << std::setw(14) << "solutions" << '\n';
+  std::vector< Traversal > traversals;
+  std::vector< HashReport > hashReports;
+  std::vector< ApplyReport > applyReports;
+  for (auto &benchCase : cases)
+  {
+    auto extra = run(benchCase, *options);
+    if (extra.traversal)
+      traversals.push_back(*extra.traversal);
+    if (extra.hashReport)
+      hashReports.push_back(*extra.hashReport);
+    std::ranges::move(extra.applyReports, std::back_inserter(applyReports));
+  }
+  if (not applyReports.empty())
+  {
+    // Hits are in percents of calls
+    std::cout << '\n' << std::left << std::setw(20) << "apply" << std::setw(8) << "phase"
+              << std::setw(8) << "op" << std::right
+              << std::setw(12) << "calls"
+              << std::setw(12) << "reset hit%"
+              << std::setw(12) << "kept hit%" << '\n';
+    for (auto &report : applyReports)
+      for (auto &op : report.stats)
+        std::cout << std::left << std::setw(20) << report.name << std::setw(8) << report.phase
+                  << std::setw(8) << op.name << std::right
+                  << std::setw(12) << op.calls
+                  << std::setw(12) << 100.0 * op.resetHits / op.calls
+                  << std::setw(12) << 100.0 * op.keptHits / op.calls << '\n';
+  }
+  if (not hashReports.empty())
+  {
+    std::cout << '\n' << std::left << std::setw(20) << "hash" << std::right
+              << std::setw(12) << "nodes"
+              << std::setw(12) << "buckets"
+              << std::setw(12) << "buddy used"
+              << std::setw(12) << "buddy max"
+              << std::setw(12) << "buddy probe"
+              << std::setw(12) << "mix used"
+              << std::setw(12) << "mix max"
+              << std::setw(12) << "mix probe"
+              << std::setw(12) << "random" << '\n';
+    for (auto &report : hashReports)
+      std::cout << std::left << std::setw(20) << report.name << std::right
+                << std::setw(12) << report.buddy.nNodes
+                << std::setw(12) << report.buddy.nBuckets
+                << std::setw(12) << report.buddy.usedBuckets
+                << std::setw(12) << report.buddy.maxChain
+                << std::setw(12) << report.buddy.avgProbe
+                << std::setw(12) << report.mix.usedBuckets
+                << std::setw(12) << report.mix.maxChain
+                << std::setw(12) << report.mix.avgProbe
+                << std::setw(12) << report.buddy.randomProbe << '\n';
+  }
+  if (traversals.empty())
+    return 0;
+  std::cout << '\n' << std::left << std::setw(20) << "traversal" << std::right
+            << std::setw(12) << "nodes"
+            << std::setw(14) << "buddy ns"
+            << std::setw(14) << "collect ns"
+            << std::setw(14) << "table ns" << '\n';
+  for (auto &traversal : traversals)
+    std::cout << std::left << std::setw(20) << traversal.name << std::right
+              << std::setw(12) << traversal.nodes
+              << std::setw(14) << traversal.buddyNs
+              << std::setw(14) << traversal.collectNs
+              << std::setw(14) << traversal.tableNs << '\n';
+  return 0;
+}
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "bdd.h"
+#include "BDDHelper.hpp"
+#include "BDDFormulaBuilder.hpp"
+#include "BDDManager.hpp"
+#include "Conditions.hpp"
+#include "DualModel.hpp"
+#include "OrderSearch.hpp"
+#include "Arguments.hpp"
+
+/**
+ * Tool that looks for good variables order for conditions
+ * and writes it to file. Then run
+ *    bdd_main --order-file FILE
+ * to use it. See OrderSearch.hpp for how it's searched.
+ *
+ * --out FILE     Where to write best order. Default is best.order.
+ * --restarts N   How many random orders to start from. Default is 1.
+ * --anneal N     Annealing steps after each sifting. Default is 200.
+ * --seed N       Seed for random orders. Default is 1.
+ * --limit N      Orders with more than N live nodes are not finished.
+ * --encoding E   Values coding: binary, fdd or onehot. Default is binary.
+ * --unique U     Uniqueness conditions: pairwise or alldiff. Default is pairwise.
+ * --dual         Add dual model conditions. Not allowed with --unique.
+ * Conditions are the same as bdd_main builds with these options,
+ * so give bdd_main the same ones together with --order-file.
+ */
+
+using namespace bddHelper;
+
+struct Options
+{
+  std::string out = "best.order";
+  orderSearch::SearchOptions search;
+  Encoding encoding = Encoding::BINARY;
+  conditions::Uniqueness uniqueness = conditions::Uniqueness::PAIRWISE;
+  bool dual = false;
+};
+
+std::optional< Options > parseOptions(int argc, char *argv[])
+{
+  Options options;
+  bool isUniqueGiven = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string_view arg = argv[i];
+    if (arg == "--dual")
+    {
+      options.dual = true;
+      continue;
+    }
+    if (i + 1 >= argc)
+      return std::nullopt;
+    if (arg == "--out")
+      options.out = argv[++i];
+    else if (arg == "--restarts" or arg == "--anneal" or arg == "--limit")
+    {
+      auto number = arguments::parseNumber< int >(argv[++i]);
+      if (not number or *number < 0)
+        return std::nullopt;
+      auto &field = arg == "--restarts" ? options.search.restarts :
+                    arg == "--anneal" ? options.search.annealSteps : options.search.nodeLimit;
+      field = *number;
+    }
+    else if (arg == "--seed")
+    {
+      auto seed = arguments::parseNumber< unsigned >(argv[++i]);
+      if (not seed)
+        return std::nullopt;
+      options.search.seed = *seed;
+    }
+    else if (arg == "--encoding")
+    {
+      auto value = arguments::parseName(arguments::encodingNames, argv[++i]);
+      if (not value)
+        return std::nullopt;
+      options.encoding = *value;
+    }
+    else if (arg == "--unique")
+    {
+      auto value = arguments::parseName(arguments::uniquenessNames, argv[++i]);
+      if (not value)
+        return std::nullopt;
+      options.uniqueness = *value;
+      isUniqueGiven = true;
+    }
+    else
+      return std::nullopt;
+  }
+  if (options.search.restarts < 0 or options.search.annealSteps < 0 or options.search.nodeLimit <= 0)
+    return std::nullopt;
+  // Dual model has uniqueness conditions of its own, see DualModel.hpp
+  if (options.dual and isUniqueGiven)
+    return std::nullopt;
+  return options;
+}
+
+int main(int argc, char *argv[])
+{
+  auto options = parseOptions(argc, argv);
+  if (not options)
+  {
+    std::cerr << "Usage: " << argv[0] << " [--out FILE] [--restarts N] [--anneal N] [--seed N] [--limit N]"
+                 " [--encoding binary|fdd|onehot] [--unique pairwise|alldiff | --dual]\n";
+    return 1;
+  }
+  // Opened before search, so bad path is known before minutes of search
+  std::ofstream out(options->out);
+  if (not out)
+  {
+    std::cerr << "Can't open " << options->out << '\n';
+    return 1;
+  }
+  // Each order change runs garbage collection over whole nodes table,
+  // so table is small here. It grows if some order needs more.
+  BDDManager manager(100000, 10000, true);
+  // Same variables as in bdd_main with default order.
+  // Saved order doesn't depend on it anyway.
+  auto h = options->encoding == Encoding::FDD ? BDDHelper::withFdd(VarOrder::OBJECT_MAJOR) :
+           options->encoding == Encoding::ONE_HOT ? BDDHelper::withOneHot(VarOrder::OBJECT_MAJOR) :
+           BDDHelper::withBinary(VarOrder::OBJECT_MAJOR);
+  // Dual variables are not in groups, they stay after ours
+  std::optional< dualModel::DualModel > dual;
+  if (options->dual)
+    dual.emplace(h);
+  // We only need conditions, they are joined by search itself
+  BDDFormulaBuilder builder;
+  conditions::addConditions(h, builder, options->uniqueness, dual ? &*dual : nullptr);
+
+  int nTried = 0;
+  options->search.report = [&nTried](const orderSearch::Candidate &candidate) {
+    std::cout << "Order " << ++nTried << ": ";
+    if (candidate.aborted)
+      std::cout << "stopped at " << candidate.peakLiveNodes << " nodes";
+    else
+      std::cout << "peak live nodes " << candidate.peakLiveNodes;
+    std::cout << ", " << candidate.seconds << " s\n";
+  };
+  auto best = orderSearch::search(h, builder.pending(), options->search);
+  if (best.aborted)
+  {
+    std::cerr << "All orders have more than " << options->search.nodeLimit << " nodes\n";
+    return 1;
+  }
+  orderSearch::writeOrder(out, best.order);
+  out.close();
+  if (not out)
+  {
+    std::cerr << "Can't write order to " << options->out << '\n';
+    return 1;
+  }
+  std::cout << "Best order: peak live nodes " << best.peakLiveNodes << ", " << best.seconds
+            << " s. Written to " << options->out << '\n';
+  return 0;
+}